@@ -32,6 +32,11 @@
 #include <asm/asm-prototypes.h>
 #include <asm/cfi.h>
 
+#define CREATE_TRACE_POINTS
+#include <trace/events/text_poke.h>
+
+EXPORT_TRACEPOINT_SYMBOL_GPL(text_poke);
+
 int __read_mostly alternatives_patched;
 
 EXPORT_SYMBOL_GPL(alternatives_patched);
@@ -2406,6 +2411,9 @@ static void text_poke_bp_batch(struct text_poke_loc *tp, unsigned int nr_entries
 	if (do_sync)
 		text_poke_sync();
 
+	for (i = 0; i < nr_entries; i++)
+		trace_text_poke(text_poke_addr(&tp[i]), tp[i].len);
+
 	/*
 	 * Remove and wait for refs to be zero.
 	 */
@@ -56,6 +56,8 @@
 #include <asm/debugreg.h>
 #include <asm/ibt.h>
 
+#include <trace/events/text_poke.h>
+
 #include "common.h"
 
 DEFINE_PER_CPU(struct kprobe *, current_kprobe) = NULL;
@@ -499,6 +501,10 @@ void *alloc_insn_page(void)
 	if (!page)
 		return NULL;
 
+	/* Pages from the ROX cache are already mapped read-only executable */
+	if (execmem_is_rox(EXECMEM_KPROBES))
+		return page;
+
 	/*
 	 * TODO: Once additional kernel code protection mechanisms are set, ensure
 	 * that the page was not maliciously altered and it is still zeroed.
@@ -819,6 +825,7 @@ void arch_arm_kprobe(struct kprobe *p)
 	text_poke(p->addr, &int3, 1);
 	text_poke_sync();
 	perf_event_text_poke(p->addr, &p->opcode, 1, &int3, 1);
+	trace_text_poke(p->addr, 1);
 }
 
 void arch_disarm_kprobe(struct kprobe *p)
@@ -828,6 +835,7 @@ void arch_disarm_kprobe(struct kprobe *p)
 	perf_event_text_poke(p->addr, &int3, 1, &p->opcode, 1);
 	text_poke(p->addr, &p->opcode, 1);
 	text_poke_sync();
+	trace_text_poke(p->addr, 1);
 }
 
 void arch_remove_kprobe(struct kprobe *p)
@@ -488,10 +488,16 @@ void arch_optimize_kprobes(struct list_head *oplist)
 		insn_buff[0] = JMP32_INSN_OPCODE;
 		*(s32 *)(&insn_buff[1]) = rel;
 
-		text_poke_bp(op->kp.addr, insn_buff, JMP32_INSN_SIZE, NULL);
+		/*
+		 * Queue the jumps so the whole list is patched with a single
+		 * round of text_poke_sync() IPIs rather than one per probe.
+		 */
+		text_poke_queue(op->kp.addr, insn_buff, JMP32_INSN_SIZE, NULL);
 
 		list_del_init(&op->list);
 	}
+
+	text_poke_finish();
 }
 
 /*
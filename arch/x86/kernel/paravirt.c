@@ -57,6 +57,9 @@ void __init native_pv_lock_init(void)
 {
 	if (boot_cpu_has(X86_FEATURE_HYPERVISOR))
 		static_branch_enable(&virt_spin_lock_key);
+
+	/* PV guests replace this again from their smp_prepare_boot_cpu() */
+	cna_configure_spin_lock_slowpath();
 }
 
 static void native_tlb_remove_table(struct mmu_gather *tlb, void *table)
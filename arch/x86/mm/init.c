@@ -1097,13 +1097,33 @@ struct execmem_info __init *execmem_arch_setup(void)
 				.pgprot	= pgprot,
 				.alignment = MODULE_ALIGN,
 			},
-			[EXECMEM_KPROBES ... EXECMEM_BPF] = {
+			/*
+			 * kprobe insn slots and BPF JIT images are only ever
+			 * written through text_poke(), so they can share the
+			 * ROX cache with module text. ftrace trampolines are
+			 * still built with plain stores before being sealed.
+			 */
+			[EXECMEM_KPROBES] = {
+				.flags	= flags,
+				.start	= start,
+				.end	= MODULES_END,
+				.pgprot	= pgprot,
+				.alignment = MODULE_ALIGN,
+			},
+			[EXECMEM_FTRACE] = {
 				.flags	= EXECMEM_KASAN_SHADOW,
 				.start	= start,
 				.end	= MODULES_END,
 				.pgprot	= PAGE_KERNEL,
 				.alignment = MODULE_ALIGN,
 			},
+			[EXECMEM_BPF] = {
+				.flags	= flags,
+				.start	= start,
+				.end	= MODULES_END,
+				.pgprot	= pgprot,
+				.alignment = MODULE_ALIGN,
+			},
 			[EXECMEM_MODULE_DATA] = {
 				.flags	= EXECMEM_KASAN_SHADOW,
 				.start	= start,
@@ -87,6 +87,11 @@ static int init_blkcg_llists(struct blkcg *blkcg)
 	blkcg->lhead = alloc_percpu_gfp(struct llist_head, GFP_KERNEL);
 	if (!blkcg->lhead)
 		return -ENOMEM;
+	blkcg->stats_updates_cpu = alloc_percpu_gfp(unsigned int, GFP_KERNEL);
+	if (!blkcg->stats_updates_cpu) {
+		free_percpu(blkcg->lhead);
+		return -ENOMEM;
+	}
 
 	for_each_possible_cpu(cpu)
 		init_llist_head(per_cpu_ptr(blkcg->lhead, cpu));
@@ -1084,9 +1089,18 @@ static void __blkcg_rstat_flush(struct blkcg *blkcg, int cpu)
 
 static void blkcg_rstat_flush(struct cgroup_subsys_state *css, int cpu)
 {
+	struct blkcg *blkcg = css_to_blkcg(css);
+
 	/* Root-level stats are sourced from system-wide IO stats */
-	if (cgroup_parent(css->cgroup))
-		__blkcg_rstat_flush(css_to_blkcg(css), cpu);
+	if (!cgroup_parent(css->cgroup))
+		return;
+
+	__blkcg_rstat_flush(blkcg, cpu);
+
+	/* see blkcg_flush_stats_reader() */
+	*per_cpu_ptr(blkcg->stats_updates_cpu, cpu) = 0;
+	if (atomic_read(&blkcg->stats_updates))
+		atomic_set(&blkcg->stats_updates, 0);
 }
 
 /*
@@ -1192,6 +1206,66 @@ static void blkcg_print_one_stat(struct blkcg_gq *blkg, struct seq_file *s)
 	seq_puts(s, "\n");
 }
 
+/* How stale the stats an io.stat reader gets are allowed to be */
+#define BLKCG_FLUSH_READER_TIME	(HZ / 10)
+
+/*
+ * IOs a CPU accounts to a blkcg before it adds them to stats_updates of the
+ * blkcg and its ancestors, and IOs per online CPU that an io.stat reader
+ * may miss.
+ */
+#define BLKCG_STATS_BATCH	64
+
+static void blkcg_stats_updated(struct blkcg *blkcg, int cpu)
+{
+	unsigned int *updates = per_cpu_ptr(blkcg->stats_updates_cpu, cpu);
+	unsigned int nr = ++*updates;
+	struct cgroup_subsys_state *css;
+
+	if (nr < BLKCG_STATS_BATCH)
+		return;
+
+	/* the root never flushes, see blkcg_fill_root_iostats() */
+	for (css = &blkcg->css; css->parent; css = css->parent)
+		atomic_add(nr, &css_to_blkcg(css)->stats_updates);
+	*updates = 0;
+}
+
+static bool blkcg_stats_need_flush(struct blkcg *blkcg)
+{
+	return atomic_read(&blkcg->stats_updates) >
+		BLKCG_STATS_BATCH * num_online_cpus();
+}
+
+/*
+ * Readers of io.stat can tolerate stats that are a little stale. Skip the
+ * rstat flush if @blkcg or any of its ancestors had its subtree flushed
+ * within BLKCG_FLUSH_READER_TIME and few IOs were accounted in @blkcg's
+ * subtree since, so that monitoring agents walking every cgroup don't
+ * serialize on the rstat lock once per cgroup, while a busy cgroup's stats
+ * never fall behind by more than about BLKCG_STATS_BATCH IOs per CPU.
+ */
+static void blkcg_flush_stats_reader(struct blkcg *blkcg)
+{
+	struct cgroup_subsys_state *css;
+	u64 now = jiffies_64;
+
+	if (blkcg_stats_need_flush(blkcg))
+		goto flush;
+
+	for (css = &blkcg->css; css; css = css->parent) {
+		u64 flush_time = READ_ONCE(css_to_blkcg(css)->flush_time);
+
+		if (flush_time &&
+		    time_before64(now, flush_time + BLKCG_FLUSH_READER_TIME))
+			return;
+	}
+
+flush:
+	cgroup_rstat_flush(blkcg->css.cgroup);
+	WRITE_ONCE(blkcg->flush_time, now);
+}
+
 static int blkcg_print_stat(struct seq_file *sf, void *v)
 {
 	struct blkcg *blkcg = css_to_blkcg(seq_css(sf));
@@ -1200,7 +1274,7 @@ static int blkcg_print_stat(struct seq_file *sf, void *v)
 	if (!seq_css(sf)->parent)
 		blkcg_fill_root_iostats();
 	else
-		cgroup_rstat_flush(blkcg->css.cgroup);
+		blkcg_flush_stats_reader(blkcg);
 
 	rcu_read_lock();
 	hlist_for_each_entry_rcu(blkg, &blkcg->blkg_list, blkcg_node) {
@@ -1363,6 +1437,7 @@ static void blkcg_css_free(struct cgroup_subsys_state *css)
 
 	mutex_unlock(&blkcg_pol_mutex);
 
+	free_percpu(blkcg->stats_updates_cpu);
 	free_percpu(blkcg->lhead);
 	kfree(blkcg);
 }
@@ -1424,6 +1499,7 @@ blkcg_css_alloc(struct cgroup_subsys_state *parent_css)
 	for (i--; i >= 0; i--)
 		if (blkcg->cpd[i])
 			blkcg_policy[i]->cpd_free_fn(blkcg->cpd[i]);
+	free_percpu(blkcg->stats_updates_cpu);
 	free_percpu(blkcg->lhead);
 free_blkcg:
 	if (blkcg != &blkcg_root)
@@ -2180,6 +2256,7 @@ void blk_cgroup_bio_start(struct bio *bio)
 
 	u64_stats_update_end_irqrestore(&bis->sync, flags);
 	cgroup_rstat_updated(blkcg->css.cgroup, cpu);
+	blkcg_stats_updated(blkcg, cpu);
 	put_cpu();
 }
 
@@ -111,6 +111,13 @@ struct blkcg {
 	 */
 	struct llist_head __percpu	*lhead;
 
+	/* jiffies_64 at the start of the last io.stat flush of this subtree */
+	u64				flush_time;
+	/* IOs accounted on each CPU and not yet added to stats_updates */
+	unsigned int __percpu		*stats_updates_cpu;
+	/* IOs accounted in this subtree since it was last flushed */
+	atomic_t			stats_updates;
+
 #ifdef CONFIG_BLK_CGROUP_FC_APPID
 	char                            fc_app_id[FC_APPID_LEN];
 #endif
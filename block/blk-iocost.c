@@ -505,6 +505,12 @@ struct ioc_gq {
 	atomic64_t			done_vtime;
 	u64				abs_vdebt;
 
+	/*
+	 * Set whenever pcpu_stat is charged, cleared by the stat flush. Lives
+	 * next to `vtime` whose cacheline the charging path dirties anyway.
+	 */
+	bool				stat_dirty;
+
 	/* current delay in effect and when it started */
 	u64				delay;
 	u64				delay_at;
@@ -725,6 +731,9 @@ static void iocg_commit_bio(struct ioc_gq *iocg, struct bio *bio,
 	gcs = get_cpu_ptr(iocg->pcpu_stat);
 	local64_add(abs_cost, &gcs->abs_vusage);
 	put_cpu_ptr(gcs);
+
+	/* pairs with xchg() in iocg_flush_stat_leaf() */
+	smp_store_release(&iocg->stat_dirty, true);
 }
 
 static void iocg_lock(struct ioc_gq *iocg, bool lock_ioc, unsigned long *flags)
@@ -1431,6 +1440,8 @@ static void iocg_incur_debt(struct ioc_gq *iocg, u64 abs_cost,
 	gcs = get_cpu_ptr(iocg->pcpu_stat);
 	local64_add(abs_cost, &gcs->abs_vusage);
 	put_cpu_ptr(gcs);
+
+	smp_store_release(&iocg->stat_dirty, true);
 }
 
 static void iocg_pay_debt(struct ioc_gq *iocg, u64 abs_vpay,
@@ -1702,6 +1713,18 @@ static void iocg_flush_stat_leaf(struct ioc_gq *iocg, struct ioc_now *now)
 
 	lockdep_assert_held(&iocg->ioc->lock);
 
+	/*
+	 * Summing the per-cpu counters of every active iocg each period is
+	 * O(nr_iocgs * nr_cpus). Skip the sum if nothing was charged since
+	 * the last flush. A charge racing with the xchg() is either seen by
+	 * the sum below or sets the flag again for the next flush.
+	 */
+	if (!xchg(&iocg->stat_dirty, false)) {
+		iocg->usage_delta_us = 0;
+		iocg_flush_stat_upward(iocg);
+		return;
+	}
+
 	/* collect per-cpu counters */
 	for_each_possible_cpu(cpu) {
 		abs_vusage += local64_read(
@@ -1279,7 +1279,7 @@ static int bch2_fiemap(struct inode *vinode, struct fiemap_extent_info *info,
 	trans = bch2_trans_get(c);
 
 	bch2_trans_iter_init(trans, &iter, BTREE_ID_extents,
-			     POS(ei->v.i_ino, start), 0);
+			     POS(ei->v.i_ino, start), BTREE_ITER_prefetch);
 
 	while (!ret || bch2_err_matches(ret, BCH_ERR_transaction_restart)) {
 		enum btree_id data_btree = BTREE_ID_extents;
@@ -1427,6 +1427,44 @@ static int z_erofs_decompress_queue(const struct z_erofs_decompressqueue *io,
 	return err;
 }
 
+static void z_erofs_decompressqueue_work(struct work_struct *work);
+
+/*
+ * Pclusters in one queue are independent, so a long queue (e.g. from a large
+ * sequential readahead) is split after this many pclusters and the remainder
+ * is handed to another worker, which splits it again in turn.
+ */
+#define Z_EROFS_FANOUT_PCLUSTERS	8
+
+static void z_erofs_decompress_fanout(struct z_erofs_decompressqueue *io)
+{
+	z_erofs_next_pcluster_t owned = io->head;
+	struct z_erofs_decompressqueue *q;
+	struct z_erofs_pcluster *pcl;
+	unsigned int nr = 0;
+
+	if (num_online_cpus() < 2)
+		return;
+
+	do {
+		pcl = container_of(owned, struct z_erofs_pcluster, next);
+		owned = READ_ONCE(pcl->next);
+		if (owned == Z_EROFS_PCLUSTER_TAIL)
+			return;
+	} while (++nr < Z_EROFS_FANOUT_PCLUSTERS);
+
+	/* if this fails, the whole queue is simply decompressed here */
+	q = kzalloc(sizeof(*q), GFP_NOWAIT | __GFP_NOWARN);
+	if (!q)
+		return;
+	q->sb = io->sb;
+	q->eio = io->eio;
+	q->head = owned;
+	WRITE_ONCE(pcl->next, Z_EROFS_PCLUSTER_TAIL);
+	INIT_WORK(&q->u.work, z_erofs_decompressqueue_work);
+	queue_work(z_erofs_workqueue, &q->u.work);
+}
+
 static void z_erofs_decompressqueue_work(struct work_struct *work)
 {
 	struct z_erofs_decompressqueue *bgq =
@@ -1434,6 +1472,7 @@ static void z_erofs_decompressqueue_work(struct work_struct *work)
 	struct page *pagepool = NULL;
 
 	DBG_BUGON(bgq->head == Z_EROFS_PCLUSTER_TAIL);
+	z_erofs_decompress_fanout(bgq);
 	z_erofs_decompress_queue(bgq, &pagepool);
 	erofs_release_pages(&pagepool);
 	kvfree(bgq);
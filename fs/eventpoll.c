@@ -1344,6 +1344,21 @@ static int ep_poll_callback(wait_queue_entry_t *wait, unsigned mode, int sync, v
 	unsigned long flags;
 	int ewake = 0;
 
+	/*
+	 * Drop wakeups for events this item is not interested in (e.g. the
+	 * EPOLLOUT wakeups every socket sees on ACK for an EPOLLIN-only
+	 * watcher) before touching ep->lock, which is shared by all CPUs
+	 * feeding this instance.  A racing ep_modify() is covered by the
+	 * f_op->poll() it does after publishing the new mask.  POLLFREE must
+	 * always take the full path.
+	 */
+	if (pollflags && !(pollflags & POLLFREE)) {
+		__poll_t events = READ_ONCE(epi->event.events);
+
+		if (!(events & ~EP_PRIVATE_BITS) || !(pollflags & events))
+			return !(events & EPOLLEXCLUSIVE);
+	}
+
 	read_lock_irqsave(&ep->lock, flags);
 
 	ep_set_busy_poll_napi_id(epi);
@@ -2445,6 +2460,33 @@ SYSCALL_DEFINE4(epoll_ctl, int, epfd, int, op, int, fd,
 	return do_epoll_ctl(epfd, op, fd, &epds, false);
 }
 
+/*
+ * Transfer the currently available events of the eventpoll @file without
+ * waiting for any. Returns the number of events copied, 0 if none were ready.
+ * Used by io_uring, which waits for the epoll file itself to become readable.
+ */
+int epoll_sendevents(struct file *file, struct epoll_event __user *events,
+		     int maxevents)
+{
+	struct eventpoll *ep;
+
+	if (maxevents <= 0 || maxevents > EP_MAX_EVENTS)
+		return -EINVAL;
+	if (!access_ok(events, maxevents * sizeof(struct epoll_event)))
+		return -EFAULT;
+	if (!is_file_epoll(file))
+		return -EINVAL;
+
+	ep = file->private_data;
+	/*
+	 * Racy check, but a miss is fine: the caller retries once the epoll
+	 * file polls readable.
+	 */
+	if (!ep_events_available(ep))
+		return 0;
+	return ep_send_events(ep, events, maxevents);
+}
+
 /*
  * Implement the event wait interface for the eventpoll file. It is the kernel
  * part of the user space epoll_wait(2).
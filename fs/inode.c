@@ -23,6 +23,7 @@
 #include <linux/rw_hint.h>
 #include <linux/seq_file.h>
 #include <linux/debugfs.h>
+#include <linux/workqueue.h>
 #include <trace/events/writeback.h>
 #define CREATE_TRACE_POINTS
 #include <trace/events/timestamp.h>
@@ -847,6 +848,64 @@ static void dispose_list(struct list_head *head)
 	}
 }
 
+/*
+ * Number of inodes evict_inodes() collects before handing them off to a
+ * worker.  Small filesystems never reach it and are disposed of inline.
+ */
+#define EVICT_INODES_BATCH	1024
+
+struct evict_inodes_ctl {
+	atomic_t		pending;
+	struct completion	done;
+};
+
+struct evict_inodes_batch {
+	struct work_struct	work;
+	struct list_head	list;
+	struct evict_inodes_ctl	*ctl;
+};
+
+static void evict_inodes_workfn(struct work_struct *work)
+{
+	struct evict_inodes_batch *batch =
+		container_of(work, struct evict_inodes_batch, work);
+	struct evict_inodes_ctl *ctl = batch->ctl;
+
+	dispose_list(&batch->list);
+	kfree(batch);
+	if (atomic_dec_and_test(&ctl->pending))
+		complete(&ctl->done);
+}
+
+/*
+ * Hand @dispose to an unbound worker on the node the inodes were allocated
+ * from, so that unmounting a filesystem with many cached inodes is not
+ * limited to one CPU.  Called with s_inode_list_lock held; the inodes on
+ * @dispose are already off s_inodes, so the workers never take that lock.
+ * Returns false if the batch could not be allocated.
+ */
+static bool evict_inodes_queue(struct list_head *dispose,
+			       struct evict_inodes_ctl *ctl)
+{
+	struct evict_inodes_batch *batch;
+	struct inode *first;
+
+	batch = kmalloc(sizeof(*batch), GFP_NOWAIT | __GFP_NOWARN);
+	if (!batch)
+		return false;
+
+	first = list_first_entry(dispose, struct inode, i_lru);
+	INIT_WORK(&batch->work, evict_inodes_workfn);
+	INIT_LIST_HEAD(&batch->list);
+	list_splice_init(dispose, &batch->list);
+	batch->ctl = ctl;
+
+	atomic_inc(&ctl->pending);
+	queue_work_node(page_to_nid(virt_to_page(first)), system_unbound_wq,
+			&batch->work);
+	return true;
+}
+
 /**
  * evict_inodes	- evict all evictable inodes for a superblock
  * @sb:		superblock to operate on
@@ -858,9 +917,13 @@ static void dispose_list(struct list_head *head)
  */
 void evict_inodes(struct super_block *sb)
 {
+	struct evict_inodes_ctl ctl;
 	struct inode *inode, *next;
+	unsigned int count = 0;
 	LIST_HEAD(dispose);
 
+	atomic_set(&ctl.pending, 1);
+	init_completion(&ctl.done);
 again:
 	spin_lock(&sb->s_inode_list_lock);
 	list_for_each_entry_safe(inode, next, &sb->s_inodes, i_sb_list) {
@@ -880,8 +943,19 @@ void evict_inodes(struct super_block *sb)
 		inode->i_state |= I_FREEING;
 		inode_lru_list_del(inode);
 		spin_unlock(&inode->i_lock);
+		/*
+		 * Unhash from s_inodes now, while we hold the lock anyway, so
+		 * that inode_sb_list_del() in evict() has nothing left to do
+		 * and the workers never contend with this walk for it.
+		 */
+		list_del_init(&inode->i_sb_list);
 		list_add(&inode->i_lru, &dispose);
 
+		/* Full batches are evicted by workers while we keep scanning */
+		if (++count >= EVICT_INODES_BATCH &&
+		    evict_inodes_queue(&dispose, &ctl))
+			count = 0;
+
 		/*
 		 * We can have a ton of inodes to evict at unmount time given
 		 * enough memory, check to see if we need to go to sleep for a
@@ -891,12 +965,17 @@ void evict_inodes(struct super_block *sb)
 			spin_unlock(&sb->s_inode_list_lock);
 			cond_resched();
 			dispose_list(&dispose);
+			count = 0;
 			goto again;
 		}
 	}
 	spin_unlock(&sb->s_inode_list_lock);
 
 	dispose_list(&dispose);
+
+	/* All evictable inodes must be gone by the time we return */
+	if (!atomic_dec_and_test(&ctl.pending))
+		wait_for_completion(&ctl.done);
 }
 EXPORT_SYMBOL_GPL(evict_inodes);
 
@@ -20,6 +20,7 @@
  * Private flags for iomap_dio, must not overlap with the public ones in
  * iomap.h:
  */
+#define IOMAP_DIO_ONSTACK	(1U << 25)
 #define IOMAP_DIO_CALLER_COMP	(1U << 26)
 #define IOMAP_DIO_INLINE_COMP	(1U << 27)
 #define IOMAP_DIO_WRITE_THROUGH	(1U << 28)
@@ -135,7 +136,8 @@ ssize_t iomap_dio_complete(struct iomap_dio *dio)
 			ret += dio->done_before;
 	}
 	trace_iomap_dio_complete(iocb, dio->error, ret);
-	kfree(dio);
+	if (!(dio->flags & IOMAP_DIO_ONSTACK))
+		kfree(dio);
 	return ret;
 }
 EXPORT_SYMBOL_GPL(iomap_dio_complete);
@@ -567,10 +569,16 @@ static loff_t iomap_dio_iter(const struct iomap_iter *iter,
  * Returns -ENOTBLK In case of a page invalidation invalidation failure for
  * writes.  The callers needs to fall back to buffered I/O in this case.
  */
-struct iomap_dio *
-__iomap_dio_rw(struct kiocb *iocb, struct iov_iter *iter,
+/*
+ * If @dio is non-NULL the caller provides the dio storage, which is only
+ * possible when we are going to wait for completion, as the dio then never
+ * outlives the caller.
+ */
+static struct iomap_dio *
+iomap_dio_start(struct kiocb *iocb, struct iov_iter *iter,
 		const struct iomap_ops *ops, const struct iomap_dio_ops *dops,
-		unsigned int dio_flags, void *private, size_t done_before)
+		unsigned int dio_flags, void *private, size_t done_before,
+		struct iomap_dio *dio)
 {
 	struct inode *inode = file_inode(iocb->ki_filp);
 	struct iomap_iter iomi = {
@@ -583,7 +591,6 @@ __iomap_dio_rw(struct kiocb *iocb, struct iov_iter *iter,
 	bool wait_for_completion =
 		is_sync_kiocb(iocb) || (dio_flags & IOMAP_DIO_FORCE_WAIT);
 	struct blk_plug plug;
-	struct iomap_dio *dio;
 	loff_t ret = 0;
 
 	trace_iomap_dio_rw_begin(iocb, iter, dio_flags, done_before);
@@ -591,9 +598,15 @@ __iomap_dio_rw(struct kiocb *iocb, struct iov_iter *iter,
 	if (!iomi.len)
 		return NULL;
 
-	dio = kmalloc(sizeof(*dio), GFP_KERNEL);
-	if (!dio)
-		return ERR_PTR(-ENOMEM);
+	if (dio) {
+		WARN_ON_ONCE(!wait_for_completion);
+		dio->flags = IOMAP_DIO_ONSTACK;
+	} else {
+		dio = kmalloc(sizeof(*dio), GFP_KERNEL);
+		if (!dio)
+			return ERR_PTR(-ENOMEM);
+		dio->flags = 0;
+	}
 
 	dio->iocb = iocb;
 	atomic_set(&dio->ref, 1);
@@ -601,7 +614,6 @@ __iomap_dio_rw(struct kiocb *iocb, struct iov_iter *iter,
 	dio->i_size = i_size_read(inode);
 	dio->dops = dops;
 	dio->error = 0;
-	dio->flags = 0;
 	dio->done_before = done_before;
 
 	dio->submit.iter = iter;
@@ -775,11 +787,21 @@ __iomap_dio_rw(struct kiocb *iocb, struct iov_iter *iter,
 	return dio;
 
 out_free_dio:
-	kfree(dio);
+	if (!(dio->flags & IOMAP_DIO_ONSTACK))
+		kfree(dio);
 	if (ret)
 		return ERR_PTR(ret);
 	return NULL;
 }
+
+struct iomap_dio *
+__iomap_dio_rw(struct kiocb *iocb, struct iov_iter *iter,
+		const struct iomap_ops *ops, const struct iomap_dio_ops *dops,
+		unsigned int dio_flags, void *private, size_t done_before)
+{
+	return iomap_dio_start(iocb, iter, ops, dops, dio_flags, private,
+			       done_before, NULL);
+}
 EXPORT_SYMBOL_GPL(__iomap_dio_rw);
 
 ssize_t
@@ -787,10 +809,19 @@ iomap_dio_rw(struct kiocb *iocb, struct iov_iter *iter,
 		const struct iomap_ops *ops, const struct iomap_dio_ops *dops,
 		unsigned int dio_flags, void *private, size_t done_before)
 {
-	struct iomap_dio *dio;
+	struct iomap_dio *dio, onstack_dio;
+
+	/*
+	 * Synchronous callers wait for all bios before we return, so the dio
+	 * can live on the stack and the allocation is saved for every I/O.
+	 */
+	if (is_sync_kiocb(iocb) || (dio_flags & IOMAP_DIO_FORCE_WAIT))
+		dio = &onstack_dio;
+	else
+		dio = NULL;
 
-	dio = __iomap_dio_rw(iocb, iter, ops, dops, dio_flags, private,
-			     done_before);
+	dio = iomap_dio_start(iocb, iter, ops, dops, dio_flags, private,
+			      done_before, dio);
 	if (IS_ERR_OR_NULL(dio))
 		return PTR_ERR_OR_ZERO(dio);
 	return iomap_dio_complete(dio);
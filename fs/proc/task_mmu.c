@@ -1063,6 +1063,15 @@ static void smap_gather_stats(struct vm_area_struct *vma,
 	if (start >= vma->vm_end)
 		return;
 
+	/*
+	 * A private anonymous VMA that never had an anon_vma attached has
+	 * never been write-faulted, so at most it maps the shared zero page,
+	 * which is not accounted.  There is nothing to find in its page
+	 * tables, and they can be very large for sparsely touched heaps.
+	 */
+	if (vma_is_anonymous(vma) && !vma->anon_vma)
+		return;
+
 	if (vma->vm_file && shmem_mapping(vma->vm_file->f_mapping)) {
 		/*
 		 * For shared or readonly shmem mappings we know that all
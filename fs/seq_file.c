@@ -175,6 +175,7 @@ ssize_t seq_read_iter(struct kiocb *iocb, struct iov_iter *iter)
 	size_t n;
 	void *p;
 	int err = 0;
+	bool overflow;
 
 	if (!iov_iter_count(iter))
 		return 0;
@@ -220,8 +221,10 @@ ssize_t seq_read_iter(struct kiocb *iocb, struct iov_iter *iter)
 		if (m->count)	// hadn't managed to copy everything
 			goto Done;
 	}
+Restart:
 	// get a non-empty record in the buffer
 	m->from = 0;
+	overflow = false;
 	p = m->op->start(m, &m->index);
 	while (1) {
 		err = PTR_ERR(p);
@@ -274,6 +277,7 @@ ssize_t seq_read_iter(struct kiocb *iocb, struct iov_iter *iter)
 			m->count = offs;
 		} else if (err || seq_has_overflowed(m)) {
 			m->count = offs;
+			overflow = !err;
 			break;
 		}
 	}
@@ -282,6 +286,13 @@ ssize_t seq_read_iter(struct kiocb *iocb, struct iov_iter *iter)
 	copied += n;
 	m->count -= n;
 	m->from = n;
+	// the buffer filled up before the reader did; with the iterator
+	// stopped and the buffer drained, start over at the record that
+	// didn't fit rather than ending the read at m->size bytes
+	if (overflow && !m->count && iov_iter_count(iter)) {
+		cond_resched();
+		goto Restart;
+	}
 Done:
 	if (unlikely(!copied)) {
 		copied = m->count ? -EFAULT : err;
@@ -219,7 +219,13 @@ static int timerfd_setup(struct timerfd_ctx *ctx, int flags,
 			else
 				alarm_start_relative(&ctx->t.alarm, texp);
 		} else {
-			hrtimer_start(&ctx->t.tmr, texp, htmode);
+			/*
+			 * Apply the caller's timer slack, as nanosleep() and
+			 * poll() do, so closely spaced timerfds can share one
+			 * timer interrupt. RT and DL tasks have no slack.
+			 */
+			hrtimer_start_range_ns(&ctx->t.tmr, texp,
+					       current->timer_slack_ns, htmode);
 		}
 
 		if (timerfd_canceled(ctx))
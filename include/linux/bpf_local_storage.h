@@ -116,10 +116,14 @@ struct bpf_local_storage {
 #define SDATA(_SELEM) (&(_SELEM)->sdata)
 
 #define BPF_LOCAL_STORAGE_CACHE_SIZE	16
+/* Slots that may be reserved by BPF_F_EXCL_CACHE maps */
+#define BPF_LOCAL_STORAGE_CACHE_EXCL_MAX	(BPF_LOCAL_STORAGE_CACHE_SIZE / 2)
 
 struct bpf_local_storage_cache {
 	spinlock_t idx_lock;
 	u64 idx_usage_counts[BPF_LOCAL_STORAGE_CACHE_SIZE];
+	/* slots owned by a single BPF_F_EXCL_CACHE map */
+	DECLARE_BITMAP(idx_excl, BPF_LOCAL_STORAGE_CACHE_SIZE);
 };
 
 #define DEFINE_BPF_STORAGE_CACHE(name)				\
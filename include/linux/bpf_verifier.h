@@ -759,6 +759,9 @@ struct bpf_verifier_env {
 	 * memory consumption during verification
 	 */
 	u32 peak_states;
+	/* number of states_equal() comparisons and of those that pruned */
+	u32 states_cmp;
+	u32 states_pruned;
 	/* longest register parentage chain walked for liveness marking */
 	u32 longest_mark_read_walk;
 	bpfptr_t fd_array;
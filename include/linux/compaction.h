@@ -101,6 +101,7 @@ bool compaction_zonelist_suitable(struct alloc_context *ac, int order,
 extern void __meminit kcompactd_run(int nid);
 extern void __meminit kcompactd_stop(int nid);
 extern void wakeup_kcompactd(pg_data_t *pgdat, int order, int highest_zoneidx);
+extern void compaction_record_demand(int nid, int order);
 
 #else
 static inline void reset_isolation_suitable(pg_data_t *pgdat)
@@ -125,6 +126,10 @@ static inline void wakeup_kcompactd(pg_data_t *pgdat,
 {
 }
 
+static inline void compaction_record_demand(int nid, int order)
+{
+}
+
 #endif /* CONFIG_COMPACTION */
 
 struct node;
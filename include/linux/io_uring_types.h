@@ -415,6 +415,11 @@ struct io_ring_ctx {
 	DECLARE_HASHTABLE(napi_ht, 4);
 #endif
 
+#ifdef CONFIG_IO_URING_LATENCY_STATS
+	/* per-opcode histograms, only allocated if enabled at ring creation */
+	struct io_lat_stats	*lat_stats;
+#endif
+
 	/* protected by ->completion_lock */
 	unsigned			evfd_last_cq_tail;
 
@@ -656,6 +661,13 @@ struct io_kiocb {
 	atomic_t			refs;
 	bool				cancel_seq_set;
 	struct io_task_work		io_task_work;
+#ifdef CONFIG_IO_URING_LATENCY_STATS
+	/* ktime_get_ns() at submission and at the last issue */
+	u64				lat_submit;
+	u64				lat_issue;
+	/* IO_LAT_*, 0 if not tracked */
+	u8				lat_how;
+#endif
 	union {
 		/*
 		 * for polled requests, i.e. IORING_OP_POLL_ADD and async armed
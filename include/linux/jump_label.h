@@ -225,6 +225,10 @@ extern bool arch_jump_label_transform_queue(struct jump_entry *entry,
 					    enum jump_label_type type);
 extern void arch_jump_label_transform_apply(void);
 extern int jump_label_text_reserved(void *start, void *end);
+extern int jump_label_for_each_entry(struct module *mod,
+				     int (*fn)(void *data, unsigned long code,
+					       unsigned long target, bool jump),
+				     void *data);
 extern bool static_key_slow_inc(struct static_key *key);
 extern bool static_key_fast_inc_not_disabled(struct static_key *key);
 extern void static_key_slow_dec(struct static_key *key);
@@ -314,6 +318,15 @@ static inline int jump_label_text_reserved(void *start, void *end)
 	return 0;
 }
 
+static inline int
+jump_label_for_each_entry(struct module *mod,
+			  int (*fn)(void *data, unsigned long code,
+				    unsigned long target, bool jump),
+			  void *data)
+{
+	return 0;
+}
+
 static inline void jump_label_lock(void) {}
 static inline void jump_label_unlock(void) {}
 
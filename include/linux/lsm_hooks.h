@@ -63,6 +63,10 @@ struct lsm_static_call {
  * This way, we can jump directly to the first used static call, and execute
  * all of them after. This essentially makes the entry point
  * dynamic to adapt the number of static calls to the number of callbacks.
+ *
+ * Each slot is guarded by its @active static key, so a hook with no
+ * registered callback costs only patched-out jumps, and a hook with a single
+ * callback makes one direct call with no indirect branch.
  */
 struct lsm_static_calls_table {
 	#define LSM_HOOK(RET, DEFAULT, NAME, ...) \
@@ -1004,6 +1004,10 @@ struct mm_struct {
 #ifdef CONFIG_IOMMU_MM_DATA
 		struct iommu_mm_data *iommu_mm;
 #endif
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+		/* Private futex hash, see PR_FUTEX_HASH */
+		struct futex_private_hash *futex_phash;
+#endif
 #ifdef CONFIG_KSM
 		/*
 		 * Represent how many pages of this process are involved in KSM
@@ -45,6 +45,12 @@
  */
 #define PAGE_ALLOC_COSTLY_ORDER 3
 
+/*
+ * Orders below this one whose allocation failures are counted so that
+ * proactive compaction can target them, see compaction_record_demand().
+ */
+#define COMPACTION_DEMAND_ORDERS (PAGE_ALLOC_COSTLY_ORDER + 2)
+
 enum migratetype {
 	MIGRATE_UNMOVABLE,
 	MIGRATE_MOVABLE,
@@ -658,16 +664,20 @@ enum zone_watermarks {
 };
 
 /*
- * One per migratetype for each PAGE_ALLOC_COSTLY_ORDER. Two additional lists
- * are added for THP. One PCP list is used by GPF_MOVABLE, and the other PCP list
- * is used by GFP_UNMOVABLE and GFP_RECLAIMABLE.
+ * One per migratetype for each order up to PCP_MAX_LOWORDER. With THP, the
+ * first order above PAGE_ALLOC_COSTLY_ORDER (64K mTHP with 4K pages) is
+ * cached as well, and two additional lists are added for PMD-sized THP. One
+ * PCP list is used by GPF_MOVABLE, and the other PCP list is used by
+ * GFP_UNMOVABLE and GFP_RECLAIMABLE.
  */
 #ifdef CONFIG_TRANSPARENT_HUGEPAGE
+#define PCP_MAX_LOWORDER (PAGE_ALLOC_COSTLY_ORDER + 1)
 #define NR_PCP_THP 2
 #else
+#define PCP_MAX_LOWORDER PAGE_ALLOC_COSTLY_ORDER
 #define NR_PCP_THP 0
 #endif
-#define NR_LOWORDER_PCP_LISTS (MIGRATE_PCPTYPES * (PAGE_ALLOC_COSTLY_ORDER + 1))
+#define NR_LOWORDER_PCP_LISTS (MIGRATE_PCPTYPES * (PCP_MAX_LOWORDER + 1))
 #define NR_PCP_LISTS (NR_LOWORDER_PCP_LISTS + NR_PCP_THP)
 
 /*
@@ -1366,6 +1376,8 @@ typedef struct pglist_data {
 	wait_queue_head_t kcompactd_wait;
 	struct task_struct *kcompactd;
 	bool proactive_compact_trigger;
+	/* Failed allocations per order, see compaction_record_demand() */
+	unsigned int kcompactd_demand[COMPACTION_DEMAND_ORDERS];
 #endif
 	/*
 	 * This is a per-node reserve of pages that are not available
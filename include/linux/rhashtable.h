@@ -22,6 +22,7 @@
 #include <linux/errno.h>
 #include <linux/jhash.h>
 #include <linux/list_nulls.h>
+#include <linux/prefetch.h>
 #include <linux/workqueue.h>
 #include <linux/rculist.h>
 #include <linux/bit_spinlock.h>
@@ -585,23 +586,19 @@ static inline int rhashtable_compare(struct rhashtable_compare_arg *arg,
 	return memcmp(ptr + ht->p.key_offset, arg->key, ht->p.key_len);
 }
 
-/* Internal function, do not use. */
-static inline struct rhash_head *__rhashtable_lookup(
-	struct rhashtable *ht, const void *key,
-	const struct rhashtable_params params)
+/* Internal function, do not use. @hash must be the hash of @key in @tbl. */
+static inline struct rhash_head *__rhashtable_lookup_hash(
+	struct rhashtable *ht, struct bucket_table *tbl, unsigned int hash,
+	const void *key, const struct rhashtable_params params)
 {
 	struct rhashtable_compare_arg arg = {
 		.ht = ht,
 		.key = key,
 	};
 	struct rhash_lock_head __rcu *const *bkt;
-	struct bucket_table *tbl;
 	struct rhash_head *he;
-	unsigned int hash;
 
-	tbl = rht_dereference_rcu(ht->tbl, ht);
 restart:
-	hash = rht_key_hashfn(ht, tbl, key, params);
 	bkt = rht_bucket(tbl, hash);
 	do {
 		rht_for_each_rcu_from(he, rht_ptr_rcu(bkt), tbl, hash) {
@@ -620,12 +617,26 @@ static inline struct rhash_head *__rhashtable_lookup(
 	smp_rmb();
 
 	tbl = rht_dereference_rcu(tbl->future_tbl, ht);
-	if (unlikely(tbl))
+	if (unlikely(tbl)) {
+		hash = rht_key_hashfn(ht, tbl, key, params);
 		goto restart;
+	}
 
 	return NULL;
 }
 
+/* Internal function, do not use. */
+static inline struct rhash_head *__rhashtable_lookup(
+	struct rhashtable *ht, const void *key,
+	const struct rhashtable_params params)
+{
+	struct bucket_table *tbl = rht_dereference_rcu(ht->tbl, ht);
+
+	return __rhashtable_lookup_hash(ht, tbl,
+					rht_key_hashfn(ht, tbl, key, params),
+					key, params);
+}
+
 /**
  * rhashtable_lookup - search hash table
  * @ht:		hash table
@@ -675,6 +686,55 @@ static inline void *rhashtable_lookup_fast(
 	return obj;
 }
 
+#define RHT_LOOKUP_BULK_BATCH	8
+
+/**
+ * rhashtable_lookup_bulk - search hash table for several keys
+ * @ht:		hash table
+ * @keys:	array of @n pointers to the keys
+ * @objs:	array of @n results
+ * @n:		number of keys
+ * @params:	hash table parameters
+ *
+ * Equivalent to calling rhashtable_lookup() for each key, storing the first
+ * matching entry or NULL in the corresponding slot of @objs.  Keys are
+ * handled RHT_LOOKUP_BULK_BATCH at a time: all of their buckets and the
+ * first entry of each chain are prefetched before any chain is walked, so
+ * the cache misses of the lookups in a batch overlap instead of being
+ * taken one after the other.
+ *
+ * This must only be called under the RCU read lock.
+ */
+static inline void rhashtable_lookup_bulk(
+	struct rhashtable *ht, const void *const *keys, void **objs,
+	unsigned int n, const struct rhashtable_params params)
+{
+	struct rhash_lock_head __rcu *const *bkts[RHT_LOOKUP_BULK_BATCH];
+	unsigned int hashes[RHT_LOOKUP_BULK_BATCH];
+	struct bucket_table *tbl;
+	struct rhash_head *he;
+	unsigned int i, j, nr;
+
+	tbl = rht_dereference_rcu(ht->tbl, ht);
+
+	for (i = 0; i < n; i += nr) {
+		nr = min_t(unsigned int, n - i, RHT_LOOKUP_BULK_BATCH);
+
+		for (j = 0; j < nr; j++) {
+			hashes[j] = rht_key_hashfn(ht, tbl, keys[i + j], params);
+			bkts[j] = rht_bucket(tbl, hashes[j]);
+			prefetch(bkts[j]);
+		}
+		for (j = 0; j < nr; j++)
+			prefetch(rht_ptr_rcu(bkts[j]));
+		for (j = 0; j < nr; j++) {
+			he = __rhashtable_lookup_hash(ht, tbl, hashes[j],
+						      keys[i + j], params);
+			objs[i + j] = he ? rht_obj(ht, he) : NULL;
+		}
+	}
+}
+
 /**
  * rhltable_lookup - search hash list table
  * @hlt:	hash table
@@ -82,6 +82,12 @@ struct sched_domain_shared {
 	atomic_t	nr_busy_cpus;
 	int		has_idle_cores;
 	int		nr_idle_scan;
+	/*
+	 * CPUs of the LLC that went idle or SCHED_IDLE only since they were
+	 * last found busy, see update_idle_cpus(). Only a hint for
+	 * select_idle_cpu().
+	 */
+	unsigned long	idle_cpus[];
 };
 
 struct sched_domain {
@@ -109,6 +115,12 @@ struct sched_domain {
 	u64 max_newidle_lb_cost;
 	unsigned long last_decay_max_lb_cost;
 
+	/* newidle pull success rate, see newidle_balance_try() */
+	unsigned int newidle_call;
+	unsigned int newidle_success;
+	unsigned int newidle_ratio;
+	unsigned int newidle_credit;
+
 #ifdef CONFIG_SCHEDSTATS
 	/* sched_balance_rq() stats */
 	unsigned int lb_count[CPU_MAX_IDLE_TYPES];
@@ -139,6 +151,9 @@ struct sched_domain {
 	unsigned int ttwu_wake_remote;
 	unsigned int ttwu_move_affine;
 	unsigned int ttwu_move_balance;
+
+	/* sched_balance_newidle() stats */
+	unsigned int newidle_skipped;
 #endif
 #ifdef CONFIG_SCHED_DEBUG
 	char *name;
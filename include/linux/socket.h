@@ -386,6 +386,7 @@ struct ucred {
 #define SOL_MCTP	285
 #define SOL_SMC		286
 #define SOL_VSOCK	287
+#define SOL_UNIX	288
 
 /* IPX options */
 #define IPX_TYPE	1
@@ -296,13 +296,18 @@ static inline bool between(__u32 seq1, __u32 seq2, __u32 seq3)
 	return seq3 - seq2 >= seq1 - seq2;
 }
 
-static inline void tcp_wmem_free_skb(struct sock *sk, struct sk_buff *skb)
+static inline void tcp_wmem_uncharge_skb(struct sock *sk, struct sk_buff *skb)
 {
 	sk_wmem_queued_add(sk, -skb->truesize);
 	if (!skb_zcopy_pure(skb))
 		sk_mem_uncharge(sk, skb->truesize);
 	else
 		sk_mem_uncharge(sk, SKB_TRUESIZE(skb_end_offset(skb)));
+}
+
+static inline void tcp_wmem_free_skb(struct sock *sk, struct sk_buff *skb)
+{
+	tcp_wmem_uncharge_skb(sk, skb);
 	__kfree_skb(skb);
 }
 
@@ -324,7 +329,7 @@ int tcp_v4_err(struct sk_buff *skb, u32);
 
 void tcp_shutdown(struct sock *sk, int how);
 
-int tcp_v4_early_demux(struct sk_buff *skb);
+int tcp_v4_early_demux(struct sk_buff *skb, struct sock *hint);
 int tcp_v4_rcv(struct sk_buff *skb);
 
 void tcp_remove_empty_skb(struct sock *sk);
@@ -2091,6 +2096,20 @@ static inline void tcp_rtx_queue_unlink_and_free(struct sk_buff *skb, struct soc
 	tcp_wmem_free_skb(sk, skb);
 }
 
+/* Same as above, but @skb is chained on @to_free for the caller to release
+ * with kfree_skb_list_reason(), which frees in bulk.
+ */
+static inline void tcp_rtx_queue_unlink_and_defer(struct sk_buff *skb,
+						  struct sock *sk,
+						  struct sk_buff **to_free)
+{
+	list_del(&skb->tcp_tsorted_anchor);
+	tcp_rtx_queue_unlink(skb, sk);
+	tcp_wmem_uncharge_skb(sk, skb);
+	skb->next = *to_free;
+	*to_free = skb;
+}
+
 static inline void tcp_write_collapse_fence(struct sock *sk)
 {
 	struct sk_buff *skb = tcp_write_queue_tail(sk);
@@ -0,0 +1,60 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM cred
+
+#if !defined(_TRACE_CRED_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _TRACE_CRED_H
+
+#include <linux/cred.h>
+#include <linux/sched.h>
+#include <linux/tracepoint.h>
+#include <linux/uidgid.h>
+
+/*
+ * Emitted by commit_creds() when a task's ids changed or it gained
+ * capabilities, so that a monitor can look at just the tasks whose
+ * credentials actually changed instead of sweeping every task.
+ * @old is still valid when the probe runs, @new is already installed.
+ */
+TRACE_EVENT(cred_change,
+
+	TP_PROTO(struct task_struct *task, const struct cred *old,
+		 const struct cred *new),
+
+	TP_ARGS(task, old, new),
+
+	TP_STRUCT__entry(
+		__field(	pid_t,	pid		)
+		__field(	uid_t,	old_uid		)
+		__field(	uid_t,	new_uid		)
+		__field(	uid_t,	old_euid	)
+		__field(	uid_t,	new_euid	)
+		__field(	gid_t,	old_egid	)
+		__field(	gid_t,	new_egid	)
+		__field(	u64,	old_cap_eff	)
+		__field(	u64,	new_cap_eff	)
+	),
+
+	TP_fast_assign(
+		__entry->pid		= task->pid;
+		__entry->old_uid	= from_kuid(&init_user_ns, old->uid);
+		__entry->new_uid	= from_kuid(&init_user_ns, new->uid);
+		__entry->old_euid	= from_kuid(&init_user_ns, old->euid);
+		__entry->new_euid	= from_kuid(&init_user_ns, new->euid);
+		__entry->old_egid	= from_kgid(&init_user_ns, old->egid);
+		__entry->new_egid	= from_kgid(&init_user_ns, new->egid);
+		__entry->old_cap_eff	= old->cap_effective.val;
+		__entry->new_cap_eff	= new->cap_effective.val;
+	),
+
+	TP_printk("pid=%d uid=%u->%u euid=%u->%u egid=%u->%u cap_eff=%llx->%llx",
+		  __entry->pid, __entry->old_uid, __entry->new_uid,
+		  __entry->old_euid, __entry->new_euid,
+		  __entry->old_egid, __entry->new_egid,
+		  __entry->old_cap_eff, __entry->new_cap_eff)
+);
+
+#endif /* _TRACE_CRED_H */
+
+/* This part must be outside protection */
+#include <trace/define_trace.h>
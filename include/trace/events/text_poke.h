@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM text_poke
+
+#if !defined(_TRACE_TEXT_POKE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _TRACE_TEXT_POKE_H
+
+#include <linux/tracepoint.h>
+
+/*
+ * Emitted once @len bytes of live kernel text at @addr have been rewritten
+ * and the new instruction is visible to all CPUs. This covers text_poke_bp()
+ * and everything batched on top of it (static calls, jump labels, ftrace
+ * call sites) as well as kprobe arming, so that integrity checkers can
+ * re-verify only the range that changed instead of polling all of .text.
+ *
+ * Probes are called with text_mutex held and must not patch text
+ * themselves.
+ */
+TRACE_EVENT(text_poke,
+
+	TP_PROTO(const void *addr, size_t len),
+
+	TP_ARGS(addr, len),
+
+	TP_STRUCT__entry(
+		__field(	unsigned long,	addr	)
+		__field(	size_t,		len	)
+	),
+
+	TP_fast_assign(
+		__entry->addr = (unsigned long)addr;
+		__entry->len = len;
+	),
+
+	TP_printk("addr=%pS len=%zu", (void *)__entry->addr, __entry->len)
+);
+
+#endif /* _TRACE_TEXT_POKE_H */
+
+/* This part must be outside protection */
+#include <trace/define_trace.h>
@@ -1413,6 +1413,9 @@ enum {
 
 /* Do not translate kernel bpf_arena pointers to user pointers */
 	BPF_F_NO_USER_CONV	= (1U << 18),
+
+/* Give a local storage map a per-owner cache slot no other map can evict */
+	BPF_F_EXCL_CACHE	= (1U << 19),
 };
 
 /* Flags for BPF_PROG_QUERY. */
@@ -1485,7 +1488,9 @@ union bpf_attr {
 		 *
 		 * BPF_MAP_TYPE_BLOOM_FILTER - the lowest 4 bits indicate the
 		 * number of hash functions (if 0, the bloom filter will default
-		 * to using 5 hash functions).
+		 * to using 5 hash functions). If bit 4 (0x10) is set, all the
+		 * bits of a value are placed in one 64-byte block, so that a
+		 * lookup touches a single cacheline.
 		 *
 		 * BPF_MAP_TYPE_ARENA - contains the address where user space
 		 * is going to mmap() the arena. It has to be page aligned.
@@ -353,4 +353,13 @@ struct prctl_mm_map {
  */
 #define PR_LOCK_SHADOW_STACK_STATUS      76
 
+/*
+ * Give the calling process its own hash table for process private futexes.
+ * This must be done before the process performs its first private futex
+ * operation; afterwards the hash can no longer be changed.
+ */
+#define PR_FUTEX_HASH			77
+# define PR_FUTEX_HASH_SET_SLOTS	1
+# define PR_FUTEX_HASH_GET_SLOTS	2
+
 #endif /* _LINUX_PRCTL_H */
@@ -260,5 +260,6 @@ __cold void io_uring_show_fdinfo(struct seq_file *m, struct file *file)
 	}
 	spin_unlock(&ctx->completion_lock);
 	napi_show_fdinfo(ctx, m);
+	io_lat_show_fdinfo(ctx, m);
 }
 #endif
@@ -349,6 +349,7 @@ static __cold struct io_ring_ctx *io_ring_ctx_alloc(struct io_uring_params *p)
 	INIT_WQ_LIST(&ctx->submit_state.compl_reqs);
 	INIT_HLIST_HEAD(&ctx->cancelable_uring_cmd);
 	io_napi_init(ctx);
+	io_lat_stats_init(ctx);
 	mutex_init(&ctx->resize_lock);
 
 	return ctx;
@@ -870,6 +871,17 @@ bool io_req_post_cqe(struct io_kiocb *req, s32 res, u32 cflags)
 	lockdep_assert(!io_wq_current_is_worker());
 	lockdep_assert_held(&ctx->uring_lock);
 
+	/*
+	 * Without a CQ lock, just fill the CQE and leave publishing the tail
+	 * and waking waiters to the flush that follows the task_work run, so
+	 * a multishot request posting many CQEs commits the CQ once.
+	 */
+	if (ctx->lockless_cq) {
+		posted = io_fill_cqe_aux(ctx, req->cqe.user_data, res, cflags);
+		ctx->submit_state.cq_flush = true;
+		return posted;
+	}
+
 	__io_cq_lock(ctx);
 	posted = io_fill_cqe_aux(ctx, req->cqe.user_data, res, cflags);
 	ctx->submit_state.cq_flush = true;
@@ -1709,6 +1721,7 @@ static int io_issue_sqe(struct io_kiocb *req, unsigned int issue_flags)
 	if (!def->audit_skip)
 		audit_uring_entry(req->opcode);
 
+	io_lat_issue(req, issue_flags);
 	ret = def->issue(req, issue_flags);
 
 	if (!def->audit_skip)
@@ -2015,6 +2028,7 @@ static int io_init_req(struct io_ring_ctx *ctx, struct io_kiocb *req,
 	req->file = NULL;
 	req->tctx = current->io_uring;
 	req->cancel_seq_set = false;
+	io_lat_submit(req);
 
 	if (unlikely(opcode >= IORING_OP_LAST)) {
 		req->opcode = 0;
@@ -2733,6 +2747,7 @@ static __cold void io_ring_ctx_free(struct io_ring_ctx *ctx)
 	if (ctx->hash_map)
 		io_wq_put_hash(ctx->hash_map);
 	io_napi_free(ctx);
+	io_lat_stats_free(ctx);
 	kvfree(ctx->cancel_table.hbs);
 	xa_destroy(&ctx->io_bl_xa);
 	kfree(ctx);
@@ -11,6 +11,7 @@
 #include "io-wq.h"
 #include "slist.h"
 #include "filetable.h"
+#include "latency.h"
 
 #ifndef CREATE_TRACE_POINTS
 #include <trace/events/io_uring.h>
@@ -202,6 +203,7 @@ static __always_inline bool io_fill_cqe_req(struct io_ring_ctx *ctx,
 		memset(&req->big_cqe, 0, sizeof(req->big_cqe));
 	}
 
+	io_lat_complete(ctx, req);
 	if (trace_io_uring_complete_enabled())
 		trace_io_uring_complete(req->ctx, req, cqe);
 	return true;
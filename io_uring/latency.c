@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Per-ring, per-opcode latency histograms, see CONFIG_IO_URING_LATENCY_STATS.
+ *
+ * Collection is switched with the kernel.io_uring_latency_stats sysctl. Only
+ * rings created while it is enabled get statistics, and they are shown in
+ * the ring's fdinfo.
+ */
+#include <linux/kernel.h>
+#include <linux/errno.h>
+#include <linux/log2.h>
+#include <linux/mm.h>
+#include <linux/seq_file.h>
+#include <linux/sysctl.h>
+#include <linux/io_uring.h>
+
+#include <uapi/linux/io_uring.h>
+
+#include "io_uring.h"
+#include "latency.h"
+
+DEFINE_STATIC_KEY_FALSE(io_lat_stats_enabled);
+
+void io_lat_stats_init(struct io_ring_ctx *ctx)
+{
+	if (!static_branch_unlikely(&io_lat_stats_enabled))
+		return;
+	/* statistics are best effort, the ring works fine without them */
+	ctx->lat_stats = kvzalloc(sizeof(*ctx->lat_stats), GFP_KERNEL_ACCOUNT);
+}
+
+void io_lat_stats_free(struct io_ring_ctx *ctx)
+{
+	kvfree(ctx->lat_stats);
+	ctx->lat_stats = NULL;
+}
+
+static unsigned int io_lat_bucket(u64 ns)
+{
+	u64 us = ns / NSEC_PER_USEC;
+
+	if (!us)
+		return 0;
+	return min_t(unsigned int, ilog2(us) + 1, IO_LAT_BUCKETS - 1);
+}
+
+void __io_lat_complete(struct io_ring_ctx *ctx, struct io_kiocb *req)
+{
+	struct io_lat_op_stats *st = &ctx->lat_stats->ops[req->opcode];
+	u64 now = ktime_get_ns();
+
+	st->issued[req->lat_how]++;
+	if (req->lat_issue >= req->lat_submit)
+		st->submit_to_issue[io_lat_bucket(req->lat_issue -
+						  req->lat_submit)]++;
+	if (now >= req->lat_issue)
+		st->issue_to_complete[io_lat_bucket(now - req->lat_issue)]++;
+	req->lat_how = 0;
+}
+
+static void io_lat_show_hist(struct seq_file *m, const char *name,
+			     const u64 *hist)
+{
+	int i;
+
+	seq_printf(m, "    %s:", name);
+	for (i = 0; i < IO_LAT_BUCKETS; i++)
+		seq_printf(m, " %llu", hist[i]);
+	seq_putc(m, '\n');
+}
+
+/*
+ * Read without synchronising against completions, so a dump taken while the
+ * ring is busy may be slightly inconsistent.
+ */
+void io_lat_show_fdinfo(struct io_ring_ctx *ctx, struct seq_file *m)
+{
+	int op;
+
+	if (!ctx->lat_stats)
+		return;
+
+	seq_puts(m, "LatencyStats:\t(buckets: 0us, then [2^(n-1), 2^n) us)\n");
+	for (op = 0; op < IORING_OP_LAST; op++) {
+		struct io_lat_op_stats *st = &ctx->lat_stats->ops[op];
+		u64 total = st->issued[IO_LAT_INLINE] + st->issued[IO_LAT_POLL] +
+			    st->issued[IO_LAT_IOWQ];
+
+		if (!total)
+			continue;
+
+		seq_printf(m, "  %s: inline=%llu poll=%llu iowq=%llu\n",
+			   io_uring_get_opcode(op), st->issued[IO_LAT_INLINE],
+			   st->issued[IO_LAT_POLL], st->issued[IO_LAT_IOWQ]);
+		io_lat_show_hist(m, "submit_to_issue", st->submit_to_issue);
+		io_lat_show_hist(m, "issue_to_complete", st->issue_to_complete);
+	}
+}
+
+#ifdef CONFIG_SYSCTL
+static struct ctl_table io_lat_stats_table[] = {
+	{
+		.procname	= "io_uring_latency_stats",
+		.data		= &io_lat_stats_enabled.key,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_do_static_key,
+		.extra1		= SYSCTL_ZERO,
+		.extra2		= SYSCTL_ONE,
+	},
+};
+
+static int __init io_lat_stats_sysctl_init(void)
+{
+	register_sysctl_init("kernel", io_lat_stats_table);
+	return 0;
+}
+__initcall(io_lat_stats_sysctl_init);
+#endif
@@ -0,0 +1,99 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+
+#ifndef IOU_LATENCY_H
+#define IOU_LATENCY_H
+
+#include <linux/kernel.h>
+#include <linux/io_uring_types.h>
+
+struct seq_file;
+
+#ifdef CONFIG_IO_URING_LATENCY_STATS
+#include <linux/jump_label.h>
+#include <linux/timekeeping.h>
+
+/* buckets are log2 of microseconds, the last one catches everything above */
+#define IO_LAT_BUCKETS		24
+
+/* how a request got to the issue that completed it */
+enum {
+	IO_LAT_INLINE = 1,
+	IO_LAT_POLL,
+	IO_LAT_IOWQ,
+	IO_LAT_NR,
+};
+
+struct io_lat_op_stats {
+	u64	submit_to_issue[IO_LAT_BUCKETS];
+	u64	issue_to_complete[IO_LAT_BUCKETS];
+	u64	issued[IO_LAT_NR];
+};
+
+/* updated when the CQE is filled, so serialised like the CQ itself */
+struct io_lat_stats {
+	struct io_lat_op_stats	ops[IORING_OP_LAST];
+};
+
+DECLARE_STATIC_KEY_FALSE(io_lat_stats_enabled);
+
+void io_lat_stats_init(struct io_ring_ctx *ctx);
+void io_lat_stats_free(struct io_ring_ctx *ctx);
+void __io_lat_complete(struct io_ring_ctx *ctx, struct io_kiocb *req);
+void io_lat_show_fdinfo(struct io_ring_ctx *ctx, struct seq_file *m);
+
+static inline bool io_lat_tracked(struct io_ring_ctx *ctx)
+{
+	return static_branch_unlikely(&io_lat_stats_enabled) && ctx->lat_stats;
+}
+
+static inline void io_lat_submit(struct io_kiocb *req)
+{
+	if (io_lat_tracked(req->ctx)) {
+		req->lat_how = 0;
+		req->lat_submit = ktime_get_ns();
+	}
+}
+
+static inline void io_lat_issue(struct io_kiocb *req, unsigned int issue_flags)
+{
+	if (io_lat_tracked(req->ctx)) {
+		if (issue_flags & IO_URING_F_IOWQ)
+			req->lat_how = IO_LAT_IOWQ;
+		else if (req->flags & REQ_F_POLLED)
+			req->lat_how = IO_LAT_POLL;
+		else
+			req->lat_how = IO_LAT_INLINE;
+		req->lat_issue = ktime_get_ns();
+	}
+}
+
+static inline void io_lat_complete(struct io_ring_ctx *ctx,
+				   struct io_kiocb *req)
+{
+	if (io_lat_tracked(ctx) && req->lat_how)
+		__io_lat_complete(ctx, req);
+}
+#else
+static inline void io_lat_stats_init(struct io_ring_ctx *ctx)
+{
+}
+static inline void io_lat_stats_free(struct io_ring_ctx *ctx)
+{
+}
+static inline void io_lat_show_fdinfo(struct io_ring_ctx *ctx,
+				      struct seq_file *m)
+{
+}
+static inline void io_lat_submit(struct io_kiocb *req)
+{
+}
+static inline void io_lat_issue(struct io_kiocb *req, unsigned int issue_flags)
+{
+}
+static inline void io_lat_complete(struct io_ring_ctx *ctx,
+				   struct io_kiocb *req)
+{
+}
+#endif /* CONFIG_IO_URING_LATENCY_STATS */
+
+#endif
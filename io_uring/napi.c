@@ -7,12 +7,15 @@
 
 /* Timeout for cleanout of stale entries. */
 #define NAPI_TIMEOUT		(60 * SEC_CONVERSION)
+/* Dynamically tracked entries not used for this long are not busy polled. */
+#define NAPI_IDLE_TIMEOUT	HZ
 
 struct io_napi_entry {
 	unsigned int		napi_id;
 	struct list_head	list;
 
 	unsigned long		timeout;
+	unsigned long		last_seen;
 	struct hlist_node	node;
 
 	struct rcu_head		rcu;
@@ -52,7 +55,10 @@ int __io_napi_add_id(struct io_ring_ctx *ctx, unsigned int napi_id)
 	scoped_guard(rcu) {
 		e = io_napi_hash_find(hash_list, napi_id);
 		if (e) {
-			WRITE_ONCE(e->timeout, jiffies + NAPI_TIMEOUT);
+			if (READ_ONCE(e->last_seen) != jiffies) {
+				WRITE_ONCE(e->timeout, jiffies + NAPI_TIMEOUT);
+				WRITE_ONCE(e->last_seen, jiffies);
+			}
 			return -EEXIST;
 		}
 	}
@@ -63,6 +69,7 @@ int __io_napi_add_id(struct io_ring_ctx *ctx, unsigned int napi_id)
 
 	e->napi_id = napi_id;
 	e->timeout = jiffies + NAPI_TIMEOUT;
+	e->last_seen = jiffies;
 
 	/*
 	 * guard(spinlock) is not used to manually unlock it before calling
@@ -162,30 +169,42 @@ static bool io_napi_busy_loop_should_end(void *data,
  */
 static bool static_tracking_do_busy_loop(struct io_ring_ctx *ctx,
 					 bool (*loop_end)(void *, unsigned long),
-					 void *loop_end_arg)
+					 void *loop_end_arg, bool *polled)
 {
 	struct io_napi_entry *e;
 
-	list_for_each_entry_rcu(e, &ctx->napi_list, list)
+	list_for_each_entry_rcu(e, &ctx->napi_list, list) {
 		napi_busy_loop_rcu(e->napi_id, loop_end, loop_end_arg,
 				   ctx->napi_prefer_busy_poll, BUSY_POLL_BUDGET);
+		*polled = true;
+	}
 	return false;
 }
 
+/*
+ * Entries are refreshed whenever a request on one of the ring's sockets is
+ * issued. Only busy poll those that were used recently, spinning on queues
+ * that mostly idle connections map to just burns CPU.
+ */
 static bool
 dynamic_tracking_do_busy_loop(struct io_ring_ctx *ctx,
 			      bool (*loop_end)(void *, unsigned long),
-			      void *loop_end_arg)
+			      void *loop_end_arg, bool *polled)
 {
 	struct io_napi_entry *e;
 	bool is_stale = false;
 
 	list_for_each_entry_rcu(e, &ctx->napi_list, list) {
-		napi_busy_loop_rcu(e->napi_id, loop_end, loop_end_arg,
-				   ctx->napi_prefer_busy_poll, BUSY_POLL_BUDGET);
-
 		if (time_after(jiffies, READ_ONCE(e->timeout)))
 			is_stale = true;
+
+		if (time_after(jiffies, READ_ONCE(e->last_seen) +
+					NAPI_IDLE_TIMEOUT))
+			continue;
+
+		napi_busy_loop_rcu(e->napi_id, loop_end, loop_end_arg,
+				   ctx->napi_prefer_busy_poll, BUSY_POLL_BUDGET);
+		*polled = true;
 	}
 
 	return is_stale;
@@ -194,11 +213,13 @@ dynamic_tracking_do_busy_loop(struct io_ring_ctx *ctx,
 static inline bool
 __io_napi_do_busy_loop(struct io_ring_ctx *ctx,
 		       bool (*loop_end)(void *, unsigned long),
-		       void *loop_end_arg)
+		       void *loop_end_arg, bool *polled)
 {
 	if (READ_ONCE(ctx->napi_track_mode) == IO_URING_NAPI_TRACKING_STATIC)
-		return static_tracking_do_busy_loop(ctx, loop_end, loop_end_arg);
-	return dynamic_tracking_do_busy_loop(ctx, loop_end, loop_end_arg);
+		return static_tracking_do_busy_loop(ctx, loop_end, loop_end_arg,
+						    polled);
+	return dynamic_tracking_do_busy_loop(ctx, loop_end, loop_end_arg,
+					     polled);
 }
 
 static void io_napi_blocking_busy_loop(struct io_ring_ctx *ctx,
@@ -208,6 +229,7 @@ static void io_napi_blocking_busy_loop(struct io_ring_ctx *ctx,
 	bool (*loop_end)(void *, unsigned long) = NULL;
 	void *loop_end_arg = NULL;
 	bool is_stale = false;
+	bool polled;
 
 	/* Singular lists use a different napi loop end check function and are
 	 * only executed once.
@@ -219,9 +241,11 @@ static void io_napi_blocking_busy_loop(struct io_ring_ctx *ctx,
 
 	scoped_guard(rcu) {
 		do {
+			polled = false;
 			is_stale = __io_napi_do_busy_loop(ctx, loop_end,
-							  loop_end_arg);
-		} while (!io_napi_busy_loop_should_end(iowq, start_time) &&
+							  loop_end_arg, &polled);
+		} while (polled &&
+			 !io_napi_busy_loop_should_end(iowq, start_time) &&
 			 !loop_end_arg);
 	}
 
@@ -386,7 +410,9 @@ int io_napi_sqpoll_busy_poll(struct io_ring_ctx *ctx)
 		return 0;
 
 	scoped_guard(rcu) {
-		is_stale = __io_napi_do_busy_loop(ctx, NULL, NULL);
+		bool polled = false;
+
+		is_stale = __io_napi_do_busy_loop(ctx, NULL, NULL, &polled);
 	}
 
 	io_napi_remove_stale(ctx, is_stale);
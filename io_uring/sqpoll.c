@@ -310,6 +310,12 @@ static int io_sq_thread(void *data)
 			if (!sqt_spin && (ret > 0 || !wq_list_empty(&ctx->iopoll_list)))
 				sqt_spin = true;
 		}
+		/*
+		 * Rotate the starting ring, so that with many rings attached the
+		 * same ones don't always wait for all the others to be served.
+		 */
+		if (cap_entries)
+			list_rotate_left(&sqd->ctx_list);
 		if (io_sq_tw(&retry_list, IORING_TW_CAP_ENTRIES_VALUE))
 			sqt_spin = true;
 
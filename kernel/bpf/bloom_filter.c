@@ -12,32 +12,70 @@
 #define BLOOM_CREATE_FLAG_MASK \
 	(BPF_F_NUMA_NODE | BPF_F_ZERO_SEED | BPF_F_ACCESS_MASK)
 
+/* map_extra layout, see BPF_MAP_TYPE_BLOOM_FILTER in uapi/linux/bpf.h */
+#define BLOOM_EXTRA_NR_HASH_MASK	0xF
+#define BLOOM_EXTRA_BLOCKED		0x10
+
+/*
+ * In the blocked layout all the bits of a value live in one cacheline sized
+ * block of the bitset. The block is picked by one hash and the bits inside it
+ * are derived from a second one, so a lookup costs two hash computations and
+ * a single cache miss regardless of nr_hash_funcs, in exchange for a somewhat
+ * higher false positive rate for the same size.
+ */
+#define BLOOM_BLOCK_BITS		512
+
 struct bpf_bloom_filter {
 	struct bpf_map map;
 	u32 bitset_mask;
 	u32 hash_seed;
 	u32 nr_hash_funcs;
-	unsigned long bitset[];
+	bool blocked;
+	unsigned long bitset[] ____cacheline_aligned;
 };
 
+static u32 __hash(struct bpf_bloom_filter *bloom, void *value,
+		  u32 value_size, u32 index)
+{
+	if (likely(value_size % 4 == 0))
+		return jhash2(value, value_size / 4, bloom->hash_seed + index);
+	return jhash(value, value_size, bloom->hash_seed + index);
+}
+
 static u32 hash(struct bpf_bloom_filter *bloom, void *value,
 		u32 value_size, u32 index)
 {
-	u32 h;
+	return __hash(bloom, value, value_size, index) & bloom->bitset_mask;
+}
 
-	if (likely(value_size % 4 == 0))
-		h = jhash2(value, value_size / 4, bloom->hash_seed + index);
-	else
-		h = jhash(value, value_size, bloom->hash_seed + index);
+/* first bit of @value's block and the hash selecting bits inside it */
+static u32 bloom_block(struct bpf_bloom_filter *bloom, void *value,
+		       u32 value_size, u32 *h2)
+{
+	*h2 = __hash(bloom, value, value_size, 1);
+	return hash(bloom, value, value_size, 0) & ~(BLOOM_BLOCK_BITS - 1);
+}
 
-	return h & bloom->bitset_mask;
+/* double hashing inside the block, the odd stride keeps the bits distinct */
+static u32 bloom_block_bit(u32 block, u32 h2, u32 i)
+{
+	return block + ((h2 + i * ((h2 >> 16) | 1)) & (BLOOM_BLOCK_BITS - 1));
 }
 
 static long bloom_map_peek_elem(struct bpf_map *map, void *value)
 {
 	struct bpf_bloom_filter *bloom =
 		container_of(map, struct bpf_bloom_filter, map);
-	u32 i, h;
+	u32 i, h, h2;
+
+	if (bloom->blocked) {
+		h = bloom_block(bloom, value, map->value_size, &h2);
+		for (i = 0; i < bloom->nr_hash_funcs; i++) {
+			if (!test_bit(bloom_block_bit(h, h2, i), bloom->bitset))
+				return -ENOENT;
+		}
+		return 0;
+	}
 
 	for (i = 0; i < bloom->nr_hash_funcs; i++) {
 		h = hash(bloom, value, map->value_size, i);
@@ -52,11 +90,18 @@ static long bloom_map_push_elem(struct bpf_map *map, void *value, u64 flags)
 {
 	struct bpf_bloom_filter *bloom =
 		container_of(map, struct bpf_bloom_filter, map);
-	u32 i, h;
+	u32 i, h, h2;
 
 	if (flags != BPF_ANY)
 		return -EINVAL;
 
+	if (bloom->blocked) {
+		h = bloom_block(bloom, value, map->value_size, &h2);
+		for (i = 0; i < bloom->nr_hash_funcs; i++)
+			set_bit(bloom_block_bit(h, h2, i), bloom->bitset);
+		return 0;
+	}
+
 	for (i = 0; i < bloom->nr_hash_funcs; i++) {
 		h = hash(bloom, value, map->value_size, i);
 		set_bit(h, bloom->bitset);
@@ -103,12 +148,12 @@ static struct bpf_map *bloom_map_alloc(union bpf_attr *attr)
 	    attr->map_flags & ~BLOOM_CREATE_FLAG_MASK ||
 	    !bpf_map_flags_access_ok(attr->map_flags) ||
 	    /* The lower 4 bits of map_extra (0xF) specify the number
-	     * of hash functions
+	     * of hash functions, bit 4 selects the blocked layout
 	     */
-	    (attr->map_extra & ~0xF))
+	    (attr->map_extra & ~(BLOOM_EXTRA_NR_HASH_MASK | BLOOM_EXTRA_BLOCKED)))
 		return ERR_PTR(-EINVAL);
 
-	nr_hash_funcs = attr->map_extra;
+	nr_hash_funcs = attr->map_extra & BLOOM_EXTRA_NR_HASH_MASK;
 	if (nr_hash_funcs == 0)
 		/* Default to using 5 hash functions if unspecified */
 		nr_hash_funcs = 5;
@@ -134,6 +179,8 @@ static struct bpf_map *bloom_map_alloc(union bpf_attr *attr)
 		bitset_bytes = BITS_TO_BYTES(U32_MAX);
 		bitset_mask = U32_MAX;
 	} else {
+		if (attr->map_extra & BLOOM_EXTRA_BLOCKED)
+			nr_bits = max_t(u32, nr_bits, BLOOM_BLOCK_BITS);
 		if (nr_bits <= BITS_PER_LONG)
 			nr_bits = BITS_PER_LONG;
 		else
@@ -152,6 +199,7 @@ static struct bpf_map *bloom_map_alloc(union bpf_attr *attr)
 
 	bloom->nr_hash_funcs = nr_hash_funcs;
 	bloom->bitset_mask = bitset_mask;
+	bloom->blocked = attr->map_extra & BLOOM_EXTRA_BLOCKED;
 
 	if (!(attr->map_flags & BPF_F_ZERO_SEED))
 		bloom->hash_seed = get_random_u32();
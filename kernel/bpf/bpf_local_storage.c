@@ -15,7 +15,8 @@
 #include <linux/rcupdate_trace.h>
 #include <linux/rcupdate_wait.h>
 
-#define BPF_LOCAL_STORAGE_CREATE_FLAG_MASK (BPF_F_NO_PREALLOC | BPF_F_CLONE)
+#define BPF_LOCAL_STORAGE_CREATE_FLAG_MASK \
+	(BPF_F_NO_PREALLOC | BPF_F_CLONE | BPF_F_EXCL_CACHE)
 
 static struct bpf_local_storage_map_bucket *
 select_bucket(struct bpf_local_storage_map *smap,
@@ -677,6 +678,32 @@ bpf_local_storage_update(void *owner, struct bpf_local_storage_map *smap,
 	return err ? ERR_PTR(err) : SDATA(selem);
 }
 
+/* Reserve a free cache_idx for the sole use of one map */
+static int bpf_local_storage_cache_idx_get_excl(struct bpf_local_storage_cache *cache)
+{
+	int res = -ENOSPC;
+	u16 i;
+
+	spin_lock(&cache->idx_lock);
+
+	if (bitmap_weight(cache->idx_excl, BPF_LOCAL_STORAGE_CACHE_SIZE) >=
+	    BPF_LOCAL_STORAGE_CACHE_EXCL_MAX)
+		goto out;
+
+	for (i = 0; i < BPF_LOCAL_STORAGE_CACHE_SIZE; i++) {
+		if (!cache->idx_usage_counts[i]) {
+			cache->idx_usage_counts[i]++;
+			__set_bit(i, cache->idx_excl);
+			res = i;
+			break;
+		}
+	}
+out:
+	spin_unlock(&cache->idx_lock);
+
+	return res;
+}
+
 static u16 bpf_local_storage_cache_idx_get(struct bpf_local_storage_cache *cache)
 {
 	u64 min_usage = U64_MAX;
@@ -685,6 +712,9 @@ static u16 bpf_local_storage_cache_idx_get(struct bpf_local_storage_cache *cache
 	spin_lock(&cache->idx_lock);
 
 	for (i = 0; i < BPF_LOCAL_STORAGE_CACHE_SIZE; i++) {
+		/* Reserved slots are never shared */
+		if (test_bit(i, cache->idx_excl))
+			continue;
 		if (cache->idx_usage_counts[i] < min_usage) {
 			min_usage = cache->idx_usage_counts[i];
 			res = i;
@@ -706,6 +736,7 @@ static void bpf_local_storage_cache_idx_free(struct bpf_local_storage_cache *cac
 {
 	spin_lock(&cache->idx_lock);
 	cache->idx_usage_counts[idx]--;
+	__clear_bit(idx, cache->idx_excl);
 	spin_unlock(&cache->idx_lock);
 }
 
@@ -854,9 +885,22 @@ bpf_local_storage_map_alloc(union bpf_attr *attr,
 		}
 	}
 
-	smap->cache_idx = bpf_local_storage_cache_idx_get(cache);
+	if (attr->map_flags & BPF_F_EXCL_CACHE) {
+		err = bpf_local_storage_cache_idx_get_excl(cache);
+		if (err < 0)
+			goto free_ma;
+		smap->cache_idx = err;
+	} else {
+		smap->cache_idx = bpf_local_storage_cache_idx_get(cache);
+	}
 	return &smap->map;
 
+free_ma:
+	if (bpf_ma) {
+		bpf_mem_alloc_destroy(&smap->selem_ma);
+		bpf_mem_alloc_destroy(&smap->storage_ma);
+	}
+
 free_smap:
 	kvfree(smap->buckets);
 	bpf_map_area_free(smap);
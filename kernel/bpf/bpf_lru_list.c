@@ -7,7 +7,13 @@
 
 #include "bpf_lru_list.h"
 
+/*
+ * Number of nodes a CPU grabs from the common LRU list each time its local
+ * free list runs dry. The actual target is scaled to the map size, see
+ * bpf_common_lru_populate().
+ */
 #define LOCAL_FREE_TARGET		(128)
+#define LOCAL_FREE_TARGET_MAX		(1024)
 #define LOCAL_NR_SCANS			LOCAL_FREE_TARGET
 
 #define PERCPU_FREE_TARGET		(4)
@@ -337,12 +343,12 @@ static void bpf_lru_list_pop_free_to_local(struct bpf_lru *lru,
 				 list) {
 		__bpf_lru_node_move_to_free(l, node, local_free_list(loc_l),
 					    BPF_LRU_LOCAL_LIST_T_FREE);
-		if (++nfree == LOCAL_FREE_TARGET)
+		if (++nfree == lru->target_free)
 			break;
 	}
 
-	if (nfree < LOCAL_FREE_TARGET)
-		__bpf_lru_list_shrink(lru, l, LOCAL_FREE_TARGET - nfree,
+	if (nfree < lru->target_free)
+		__bpf_lru_list_shrink(lru, l, lru->target_free - nfree,
 				      local_free_list(loc_l),
 				      BPF_LRU_LOCAL_LIST_T_FREE);
 
@@ -610,15 +616,31 @@ static void bpf_percpu_lru_populate(struct bpf_lru *lru, void *buf,
 	}
 }
 
+/*
+ * Each CPU may hold up to target_free nodes on its local free list, which are
+ * unavailable to the other CPUs. Keep that to about half of the map for small
+ * maps, so CPUs don't end up evicting from each other's free lists, and let
+ * large maps refill in bigger batches so they take the common list lock less
+ * often. The scan depth follows, so the rotation work per node stays the same.
+ */
+static void bpf_common_lru_set_target(struct bpf_lru *lru, u32 nr_elems)
+{
+	lru->target_free = clamp(nr_elems / num_possible_cpus() / 2, 1,
+				 LOCAL_FREE_TARGET_MAX);
+	lru->nr_scans = max_t(unsigned int, lru->target_free, LOCAL_NR_SCANS);
+}
+
 void bpf_lru_populate(struct bpf_lru *lru, void *buf, u32 node_offset,
 		      u32 elem_size, u32 nr_elems)
 {
-	if (lru->percpu)
+	if (lru->percpu) {
 		bpf_percpu_lru_populate(lru, buf, node_offset, elem_size,
 					nr_elems);
-	else
+	} else {
+		bpf_common_lru_set_target(lru, nr_elems);
 		bpf_common_lru_populate(lru, buf, node_offset, elem_size,
 					nr_elems);
+	}
 }
 
 static void bpf_lru_locallist_init(struct bpf_lru_locallist *loc_l, int cpu)
@@ -681,6 +703,7 @@ int bpf_lru_init(struct bpf_lru *lru, bool percpu, u32 hash_offset,
 
 		bpf_lru_list_init(&clru->lru_list);
 		lru->nr_scans = LOCAL_NR_SCANS;
+		lru->target_free = LOCAL_FREE_TARGET;
 	}
 
 	lru->percpu = percpu;
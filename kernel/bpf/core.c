@@ -906,6 +906,22 @@ static LIST_HEAD(pack_list);
 
 #define BPF_PROG_CHUNK_COUNT (BPF_PROG_PACK_SIZE / BPF_PROG_CHUNK_SIZE)
 
+/* Fill a freshly allocated JIT region with traps and make it read-only
+ * executable. When EXECMEM_BPF is backed by the execmem ROX cache the
+ * memory already comes filled with trapping instructions and mapped ROX
+ * with huge pages, and must not be written to or split here.
+ */
+static int bpf_prog_pack_seal(void *ptr, unsigned long size,
+			      bpf_jit_fill_hole_t bpf_fill_ill_insns)
+{
+	if (execmem_is_rox(EXECMEM_BPF))
+		return 0;
+
+	bpf_fill_ill_insns(ptr, size);
+	set_vm_flush_reset_perms(ptr);
+	return set_memory_rox((unsigned long)ptr, size / PAGE_SIZE);
+}
+
 static struct bpf_prog_pack *alloc_new_pack(bpf_jit_fill_hole_t bpf_fill_ill_insns)
 {
 	struct bpf_prog_pack *pack;
@@ -918,12 +934,10 @@ static struct bpf_prog_pack *alloc_new_pack(bpf_jit_fill_hole_t bpf_fill_ill_ins
 	pack->ptr = bpf_jit_alloc_exec(BPF_PROG_PACK_SIZE);
 	if (!pack->ptr)
 		goto out;
-	bpf_fill_ill_insns(pack->ptr, BPF_PROG_PACK_SIZE);
 	bitmap_zero(pack->bitmap, BPF_PROG_PACK_SIZE / BPF_PROG_CHUNK_SIZE);
 
-	set_vm_flush_reset_perms(pack->ptr);
-	err = set_memory_rox((unsigned long)pack->ptr,
-			     BPF_PROG_PACK_SIZE / PAGE_SIZE);
+	err = bpf_prog_pack_seal(pack->ptr, BPF_PROG_PACK_SIZE,
+				 bpf_fill_ill_insns);
 	if (err)
 		goto out;
 	list_add_tail(&pack->list, &pack_list);
@@ -949,10 +963,7 @@ void *bpf_prog_pack_alloc(u32 size, bpf_jit_fill_hole_t bpf_fill_ill_insns)
 		if (ptr) {
 			int err;
 
-			bpf_fill_ill_insns(ptr, size);
-			set_vm_flush_reset_perms(ptr);
-			err = set_memory_rox((unsigned long)ptr,
-					     size / PAGE_SIZE);
+			err = bpf_prog_pack_seal(ptr, size, bpf_fill_ill_insns);
 			if (err) {
 				bpf_jit_free_exec(ptr);
 				ptr = NULL;
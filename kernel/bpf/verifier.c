@@ -17839,6 +17839,8 @@ static bool states_equal(struct bpf_verifier_env *env,
 {
 	int i;
 
+	env->states_cmp++;
+
 	if (old->curframe != cur->curframe)
 		return false;
 
@@ -18305,6 +18307,7 @@ static int is_state_visited(struct bpf_verifier_env *env, int insn_idx)
 				update_loop_entry(cur, loop_entry);
 hit:
 			sl->hit_cnt++;
+			env->states_pruned++;
 			/* reached equivalent register/stack state,
 			 * prune the search.
 			 * Registers read by the continuation are read by us.
@@ -21959,6 +21962,8 @@ static void print_verification_stats(struct bpf_verifier_env *env)
 				verbose(env, "+");
 		}
 		verbose(env, "\n");
+		verbose(env, "states compared %u pruned %u\n",
+			env->states_cmp, env->states_pruned);
 	}
 	verbose(env, "processed %d insns (limit %d) max_states_per_insn %d "
 		"total_states %d peak_states %d mark_read %d\n",
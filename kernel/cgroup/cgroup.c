@@ -32,6 +32,7 @@
 
 #include <linux/bpf-cgroup.h>
 #include <linux/cred.h>
+#include <linux/ctype.h>
 #include <linux/errno.h>
 #include <linux/init_task.h>
 #include <linux/kernel.h>
@@ -44,6 +45,7 @@
 #include <linux/sched.h>
 #include <linux/sched/task.h>
 #include <linux/slab.h>
+#include <linux/sort.h>
 #include <linux/spinlock.h>
 #include <linux/percpu-rwsem.h>
 #include <linux/string.h>
@@ -2837,6 +2839,36 @@ int cgroup_migrate_prepare_dst(struct cgroup_mgctx *mgctx)
 	return 0;
 }
 
+/*
+ * Body of cgroup_migrate() for several processes or tasks at once, so that
+ * they all go through one cgroup_migrate_execute().
+ */
+static int cgroup_migrate_leaders(struct task_struct **leaders,
+				  unsigned int nr, bool threadgroup,
+				  struct cgroup_mgctx *mgctx)
+{
+	struct task_struct *task;
+	unsigned int i;
+
+	/*
+	 * The following thread iteration should be inside an RCU critical
+	 * section to prevent tasks from being freed while taking the snapshot.
+	 * spin_lock_irq() implies RCU critical section here.
+	 */
+	spin_lock_irq(&css_set_lock);
+	for (i = 0; i < nr; i++) {
+		task = leaders[i];
+		do {
+			cgroup_migrate_add_task(task, mgctx);
+			if (!threadgroup)
+				break;
+		} while_each_thread(leaders[i], task);
+	}
+	spin_unlock_irq(&css_set_lock);
+
+	return cgroup_migrate_execute(mgctx);
+}
+
 /**
  * cgroup_migrate - migrate a process or task to a cgroup
  * @leader: the leader of the process or the task to migrate
@@ -2858,65 +2890,107 @@ int cgroup_migrate_prepare_dst(struct cgroup_mgctx *mgctx)
 int cgroup_migrate(struct task_struct *leader, bool threadgroup,
 		   struct cgroup_mgctx *mgctx)
 {
-	struct task_struct *task;
-
-	/*
-	 * The following thread iteration should be inside an RCU critical
-	 * section to prevent tasks from being freed while taking the snapshot.
-	 * spin_lock_irq() implies RCU critical section here.
-	 */
-	spin_lock_irq(&css_set_lock);
-	task = leader;
-	do {
-		cgroup_migrate_add_task(task, mgctx);
-		if (!threadgroup)
-			break;
-	} while_each_thread(leader, task);
-	spin_unlock_irq(&css_set_lock);
-
-	return cgroup_migrate_execute(mgctx);
+	return cgroup_migrate_leaders(&leader, 1, threadgroup, mgctx);
 }
 
 /**
- * cgroup_attach_task - attach a task or a whole threadgroup to a cgroup
+ * cgroup_attach_tasks - attach several tasks or threadgroups to a cgroup
  * @dst_cgrp: the cgroup to attach to
- * @leader: the task or the leader of the threadgroup to be attached
- * @threadgroup: attach the whole threadgroup?
+ * @leaders: the tasks or the leaders of the threadgroups to be attached
+ * @nr: number of entries in @leaders
+ * @threadgroup: attach whole threadgroups?
+ *
+ * All of @leaders are migrated in one go: the controllers see a single
+ * ->can_attach() and ->attach() for the whole set, and either all tasks
+ * are migrated or none.  @leaders must not contain duplicates.
  *
  * Call holding cgroup_mutex and cgroup_threadgroup_rwsem.
  */
-int cgroup_attach_task(struct cgroup *dst_cgrp, struct task_struct *leader,
-		       bool threadgroup)
+static int cgroup_attach_tasks(struct cgroup *dst_cgrp,
+			       struct task_struct **leaders, unsigned int nr,
+			       bool threadgroup)
 {
 	DEFINE_CGROUP_MGCTX(mgctx);
 	struct task_struct *task;
+	unsigned int i;
 	int ret = 0;
 
 	/* look up all src csets */
 	spin_lock_irq(&css_set_lock);
 	rcu_read_lock();
-	task = leader;
-	do {
-		cgroup_migrate_add_src(task_css_set(task), dst_cgrp, &mgctx);
-		if (!threadgroup)
-			break;
-	} while_each_thread(leader, task);
+	for (i = 0; i < nr; i++) {
+		task = leaders[i];
+		do {
+			cgroup_migrate_add_src(task_css_set(task), dst_cgrp,
+					       &mgctx);
+			if (!threadgroup)
+				break;
+		} while_each_thread(leaders[i], task);
+	}
 	rcu_read_unlock();
 	spin_unlock_irq(&css_set_lock);
 
 	/* prepare dst csets and commit */
 	ret = cgroup_migrate_prepare_dst(&mgctx);
 	if (!ret)
-		ret = cgroup_migrate(leader, threadgroup, &mgctx);
+		ret = cgroup_migrate_leaders(leaders, nr, threadgroup, &mgctx);
 
 	cgroup_migrate_finish(&mgctx);
 
 	if (!ret)
-		TRACE_CGROUP_PATH(attach_task, dst_cgrp, leader, threadgroup);
+		for (i = 0; i < nr; i++)
+			TRACE_CGROUP_PATH(attach_task, dst_cgrp, leaders[i],
+					  threadgroup);
 
 	return ret;
 }
 
+/**
+ * cgroup_attach_task - attach a task or a whole threadgroup to a cgroup
+ * @dst_cgrp: the cgroup to attach to
+ * @leader: the task or the leader of the threadgroup to be attached
+ * @threadgroup: attach the whole threadgroup?
+ *
+ * Call holding cgroup_mutex and cgroup_threadgroup_rwsem.
+ */
+int cgroup_attach_task(struct cgroup *dst_cgrp, struct task_struct *leader,
+		       bool threadgroup)
+{
+	return cgroup_attach_tasks(dst_cgrp, &leader, 1, threadgroup);
+}
+
+/*
+ * Look up the task to migrate for a PID written to cgroup.procs or
+ * cgroup.threads. Returns an ERR_PTR() if there is none or it may not be
+ * migrated. Called under rcu_read_lock().
+ */
+static struct task_struct *cgroup_procs_find_task(pid_t pid, bool threadgroup)
+{
+	struct task_struct *tsk;
+
+	if (pid) {
+		tsk = find_task_by_vpid(pid);
+		if (!tsk)
+			return ERR_PTR(-ESRCH);
+	} else {
+		tsk = current;
+	}
+
+	if (threadgroup)
+		tsk = tsk->group_leader;
+
+	/*
+	 * kthreads may acquire PF_NO_SETAFFINITY during initialization.
+	 * If userland migrates such a kthread to a non-root cgroup, it can
+	 * become trapped in a cpuset, or RT kthread may be born in a
+	 * cgroup with no rt_runtime allocated.  Just say no.
+	 */
+	if (tsk->no_cgroup_migration || (tsk->flags & PF_NO_SETAFFINITY))
+		return ERR_PTR(-EINVAL);
+
+	return tsk;
+}
+
 struct task_struct *cgroup_procs_write_start(char *buf, bool threadgroup,
 					     bool *threadgroup_locked)
 {
@@ -2939,29 +3013,9 @@ struct task_struct *cgroup_procs_write_start(char *buf, bool threadgroup,
 	cgroup_attach_lock(*threadgroup_locked);
 
 	rcu_read_lock();
-	if (pid) {
-		tsk = find_task_by_vpid(pid);
-		if (!tsk) {
-			tsk = ERR_PTR(-ESRCH);
-			goto out_unlock_threadgroup;
-		}
-	} else {
-		tsk = current;
-	}
-
-	if (threadgroup)
-		tsk = tsk->group_leader;
-
-	/*
-	 * kthreads may acquire PF_NO_SETAFFINITY during initialization.
-	 * If userland migrates such a kthread to a non-root cgroup, it can
-	 * become trapped in a cpuset, or RT kthread may be born in a
-	 * cgroup with no rt_runtime allocated.  Just say no.
-	 */
-	if (tsk->no_cgroup_migration || (tsk->flags & PF_NO_SETAFFINITY)) {
-		tsk = ERR_PTR(-EINVAL);
+	tsk = cgroup_procs_find_task(pid, threadgroup);
+	if (IS_ERR(tsk))
 		goto out_unlock_threadgroup;
-	}
 
 	get_task_struct(tsk);
 	goto out_unlock_rcu;
@@ -5187,6 +5241,144 @@ static int cgroup_attach_permissions(struct cgroup *src_cgrp,
 	return ret;
 }
 
+static unsigned int cgroup_procs_count_pids(const char *buf)
+{
+	unsigned int nr = 0;
+	bool in_pid = false;
+
+	for (; *buf; buf++) {
+		if (isspace(*buf))
+			in_pid = false;
+		else if (!in_pid) {
+			in_pid = true;
+			nr++;
+		}
+	}
+	return nr;
+}
+
+static int cgroup_task_ptr_cmp(const void *a, const void *b)
+{
+	const struct task_struct *ta = *(struct task_struct * const *)a;
+	const struct task_struct *tb = *(struct task_struct * const *)b;
+
+	return ta < tb ? -1 : ta > tb;
+}
+
+/*
+ * Several PIDs, separated by any whitespace, written to cgroup.procs or
+ * cgroup.threads at once are migrated in one transaction.
+ * cgroup_threadgroup_rwsem is write-locked once and the controllers'
+ * ->can_attach() and ->attach() run once for the whole batch. The permission
+ * and domain checks of a single-PID write are applied to every task, and if
+ * any PID is invalid or any task can't be migrated, the write fails and none
+ * of them is moved. A process listed more than once, directly or through
+ * several of its TIDs in cgroup.procs, is migrated once. A write is limited
+ * to one page, so longer lists have to be split over several writes, each of
+ * which is its own transaction.
+ */
+static ssize_t __cgroup_procs_write_batch(struct kernfs_open_file *of,
+					  char *buf, unsigned int nr,
+					  bool threadgroup)
+{
+	struct cgroup_file_ctx *ctx = of->priv;
+	struct cgroup *src_cgrp, *dst_cgrp;
+	struct task_struct **tasks;
+	const struct cred *saved_cred;
+	struct cgroup_subsys *ss;
+	unsigned int i, j, n = 0;
+	ssize_t ret = 0;
+	char *tok;
+	int ssid;
+
+	tasks = kvmalloc_array(nr, sizeof(*tasks), GFP_KERNEL);
+	if (!tasks)
+		return -ENOMEM;
+
+	dst_cgrp = cgroup_kn_lock_live(of->kn, false);
+	if (!dst_cgrp) {
+		ret = -ENODEV;
+		goto out_free;
+	}
+
+	cgroup_attach_lock(true);
+
+	rcu_read_lock();
+	while (n < nr) {
+		struct task_struct *tsk;
+		pid_t pid;
+
+		/* split on isspace(), as cgroup_procs_count_pids() counts */
+		tok = skip_spaces(buf);
+		if (!*tok)
+			break;
+		for (buf = tok; *buf && !isspace(*buf); buf++)
+			;
+		if (*buf)
+			*buf++ = '\0';
+
+		if (kstrtoint(tok, 0, &pid) || pid < 0) {
+			ret = -EINVAL;
+			break;
+		}
+		tsk = cgroup_procs_find_task(pid, threadgroup);
+		if (IS_ERR(tsk)) {
+			ret = PTR_ERR(tsk);
+			break;
+		}
+		get_task_struct(tsk);
+		tasks[n++] = tsk;
+	}
+	rcu_read_unlock();
+	if (ret)
+		goto out_put;
+
+	/*
+	 * Threads of one process resolve to the same leader, and a PID may
+	 * simply be listed twice; migrate every task only once.
+	 */
+	sort(tasks, n, sizeof(*tasks), cgroup_task_ptr_cmp, NULL);
+	for (i = 1, j = 1; i < n; i++) {
+		if (tasks[i] == tasks[j - 1]) {
+			put_task_struct(tasks[i]);
+			continue;
+		}
+		tasks[j++] = tasks[i];
+	}
+	if (n)
+		n = j;
+
+	/* see __cgroup_procs_write() */
+	saved_cred = override_creds(of->file->f_cred);
+	for (i = 0; i < n && !ret; i++) {
+		spin_lock_irq(&css_set_lock);
+		src_cgrp = task_cgroup_from_root(tasks[i], &cgrp_dfl_root);
+		spin_unlock_irq(&css_set_lock);
+
+		ret = cgroup_attach_permissions(src_cgrp, dst_cgrp,
+						of->file->f_path.dentry->d_sb,
+						threadgroup, ctx->ns);
+	}
+	revert_creds(saved_cred);
+
+	if (!ret)
+		ret = cgroup_attach_tasks(dst_cgrp, tasks, n, threadgroup);
+
+out_put:
+	for (i = 0; i < n; i++)
+		put_task_struct(tasks[i]);
+	cgroup_attach_unlock(true);
+
+	for_each_subsys(ss, ssid)
+		if (ss->post_attach)
+			ss->post_attach();
+
+	cgroup_kn_unlock(of->kn);
+out_free:
+	kvfree(tasks);
+	return ret;
+}
+
 static ssize_t __cgroup_procs_write(struct kernfs_open_file *of, char *buf,
 				    bool threadgroup)
 {
@@ -5194,9 +5386,15 @@ static ssize_t __cgroup_procs_write(struct kernfs_open_file *of, char *buf,
 	struct cgroup *src_cgrp, *dst_cgrp;
 	struct task_struct *task;
 	const struct cred *saved_cred;
+	unsigned int nr_pids;
 	ssize_t ret;
 	bool threadgroup_locked;
 
+	nr_pids = cgroup_procs_count_pids(buf);
+	if (nr_pids > 1)
+		return __cgroup_procs_write_batch(of, buf, nr_pids,
+						  threadgroup);
+
 	dst_cgrp = cgroup_kn_lock_live(of->kn, false);
 	if (!dst_cgrp)
 		return -ENODEV;
@@ -20,6 +20,11 @@
 #include <linux/cn_proc.h>
 #include <linux/uidgid.h>
 
+#define CREATE_TRACE_POINTS
+#include <trace/events/cred.h>
+
+EXPORT_TRACEPOINT_SYMBOL_GPL(cred_change);
+
 #if 0
 #define kdebug(FMT, ...)						\
 	printk("[%-5.5s%5u] " FMT "\n",					\
@@ -393,6 +398,7 @@ int commit_creds(struct cred *new)
 {
 	struct task_struct *task = current;
 	const struct cred *old = task->real_cred;
+	bool uid_changed, gid_changed;
 
 	kdebug("commit_creds(%p{%ld})", new,
 	       atomic_long_read(&new->usage));
@@ -441,18 +447,23 @@ int commit_creds(struct cred *new)
 		dec_rlimit_ucounts(old->ucounts, UCOUNT_RLIMIT_NPROC, 1);
 
 	/* send notifications */
-	if (!uid_eq(new->uid,   old->uid)  ||
-	    !uid_eq(new->euid,  old->euid) ||
-	    !uid_eq(new->suid,  old->suid) ||
-	    !uid_eq(new->fsuid, old->fsuid))
+	uid_changed = !uid_eq(new->uid,   old->uid)  ||
+		      !uid_eq(new->euid,  old->euid) ||
+		      !uid_eq(new->suid,  old->suid) ||
+		      !uid_eq(new->fsuid, old->fsuid);
+	if (uid_changed)
 		proc_id_connector(task, PROC_EVENT_UID);
 
-	if (!gid_eq(new->gid,   old->gid)  ||
-	    !gid_eq(new->egid,  old->egid) ||
-	    !gid_eq(new->sgid,  old->sgid) ||
-	    !gid_eq(new->fsgid, old->fsgid))
+	gid_changed = !gid_eq(new->gid,   old->gid)  ||
+		      !gid_eq(new->egid,  old->egid) ||
+		      !gid_eq(new->sgid,  old->sgid) ||
+		      !gid_eq(new->fsgid, old->fsgid);
+	if (gid_changed)
 		proc_id_connector(task, PROC_EVENT_GID);
 
+	if (uid_changed || gid_changed || !cred_cap_issubset(old, new))
+		trace_cred_change(task, old, new);
+
 	/* release the old obj and subj refs both */
 	put_cred_many(old, 2);
 	return 0;
@@ -39,6 +39,7 @@
 #include <linux/memblock.h>
 #include <linux/fault-inject.h>
 #include <linux/slab.h>
+#include <linux/prctl.h>
 
 #include "futex.h"
 #include "../locking/rtmutex_common.h"
@@ -107,18 +108,152 @@ late_initcall(fail_futex_debugfs);
 
 #endif /* CONFIG_FAIL_FUTEX */
 
+static void futex_hash_bucket_init(struct futex_hash_bucket *fhb)
+{
+	atomic_set(&fhb->waiters, 0);
+	plist_head_init(&fhb->chain);
+	spin_lock_init(&fhb->lock);
+}
+
+struct futex_private_hash {
+	struct futex_hash_bucket *queues;
+	unsigned int		 hash_mask;
+};
+
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+/*
+ * Per-process hash for PROCESS_PRIVATE futexes, see PR_FUTEX_HASH.
+ *
+ * mm->futex_phash starts out NULL. The first private futex operation of the
+ * process either finds a private hash installed by PR_FUTEX_HASH, or commits
+ * the mm to the global hash by setting it to FUTEX_PHASH_GLOBAL. After that
+ * it never changes for the lifetime of the mm, so waiters and wakers always
+ * agree on the bucket and nothing ever has to be rehashed. The hash is freed
+ * together with the mm; every private futex user holds a reference on it.
+ */
+#define FUTEX_PHASH_GLOBAL	((struct futex_private_hash *)1UL)
+
+static struct futex_private_hash *futex_private_hash(union futex_key *key)
+{
+	struct mm_struct *mm = key->private.mm;
+	struct futex_private_hash *fph;
+
+	if (key->both.offset & (FUT_OFF_INODE | FUT_OFF_MMSHARED))
+		return NULL;
+
+	/* Pairs with the cmpxchg() in futex_hash_allocate(). */
+	fph = smp_load_acquire(&mm->futex_phash);
+	if (unlikely(!fph)) {
+		fph = cmpxchg(&mm->futex_phash, NULL, FUTEX_PHASH_GLOBAL);
+		if (!fph)
+			return NULL;
+	}
+
+	return fph == FUTEX_PHASH_GLOBAL ? NULL : fph;
+}
+
+static int futex_hash_allocate(unsigned int slots)
+{
+	struct mm_struct *mm = current->mm;
+	struct futex_private_hash *fph;
+	unsigned int i;
+
+	if (slots < 2 || slots > futex_hashsize || !is_power_of_2(slots))
+		return -EINVAL;
+
+	if (READ_ONCE(mm->futex_phash))
+		return -EBUSY;
+
+	fph = kmalloc(sizeof(*fph), GFP_KERNEL_ACCOUNT);
+	if (!fph)
+		return -ENOMEM;
+
+	fph->queues = kvcalloc(slots, sizeof(*fph->queues), GFP_KERNEL_ACCOUNT);
+	if (!fph->queues) {
+		kfree(fph);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < slots; i++)
+		futex_hash_bucket_init(&fph->queues[i]);
+	fph->hash_mask = slots - 1;
+
+	/* Lost against the first private futex operation or another caller. */
+	if (cmpxchg(&mm->futex_phash, NULL, fph)) {
+		kvfree(fph->queues);
+		kfree(fph);
+		return -EBUSY;
+	}
+
+	return 0;
+}
+
+static int futex_hash_get_slots(void)
+{
+	struct futex_private_hash *fph = READ_ONCE(current->mm->futex_phash);
+
+	if (!fph || fph == FUTEX_PHASH_GLOBAL)
+		return 0;
+
+	return fph->hash_mask + 1;
+}
+
+int futex_hash_prctl(unsigned long arg2, unsigned long arg3)
+{
+	switch (arg2) {
+	case PR_FUTEX_HASH_SET_SLOTS:
+		if (arg3 > UINT_MAX)
+			return -EINVAL;
+		return futex_hash_allocate(arg3);
+
+	case PR_FUTEX_HASH_GET_SLOTS:
+		if (arg3)
+			return -EINVAL;
+		return futex_hash_get_slots();
+	}
+
+	return -EINVAL;
+}
+
+void futex_mm_init(struct mm_struct *mm)
+{
+	mm->futex_phash = NULL;
+}
+
+void futex_hash_free(struct mm_struct *mm)
+{
+	struct futex_private_hash *fph = mm->futex_phash;
+
+	if (!fph || fph == FUTEX_PHASH_GLOBAL)
+		return;
+
+	kvfree(fph->queues);
+	kfree(fph);
+}
+#else
+static inline struct futex_private_hash *futex_private_hash(union futex_key *key)
+{
+	return NULL;
+}
+#endif /* CONFIG_FUTEX_PRIVATE_HASH */
+
 /**
- * futex_hash - Return the hash bucket in the global hash
+ * futex_hash - Return the hash bucket for a futex key
  * @key:	Pointer to the futex key for which the hash is calculated
  *
  * We hash on the keys returned from get_futex_key (see below) and return the
- * corresponding hash bucket in the global hash.
+ * corresponding hash bucket in the process private hash if the key is
+ * private and the process has one, or in the global hash otherwise.
  */
 struct futex_hash_bucket *futex_hash(union futex_key *key)
 {
+	struct futex_private_hash *fph = futex_private_hash(key);
 	u32 hash = jhash2((u32 *)key, offsetof(typeof(*key), both.offset) / 4,
 			  key->both.offset);
 
+	if (fph)
+		return &fph->queues[hash & fph->hash_mask];
+
 	return &futex_queues[hash & (futex_hashsize - 1)];
 }
 
@@ -1163,11 +1298,8 @@ static int __init futex_init(void)
 					       futex_hashsize, futex_hashsize);
 	futex_hashsize = 1UL << futex_shift;
 
-	for (i = 0; i < futex_hashsize; i++) {
-		atomic_set(&futex_queues[i].waiters, 0);
-		plist_head_init(&futex_queues[i].chain);
-		spin_lock_init(&futex_queues[i].lock);
-	}
+	for (i = 0; i < futex_hashsize; i++)
+		futex_hash_bucket_init(&futex_queues[i]);
 
 	return 0;
 }
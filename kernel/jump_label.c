@@ -893,6 +893,50 @@ int jump_label_text_reserved(void *start, void *end)
 	return ret;
 }
 
+/**
+ * jump_label_for_each_entry - walk the jump sites of the kernel or a module
+ * @mod: module whose sites to walk, or NULL for the core kernel
+ * @fn: called for each site with its code address, its jump target and
+ *	whether it currently jumps; a non-zero return stops the walk
+ * @data: passed to @fn
+ *
+ * Lets integrity checkers take a compact snapshot of every site's state in
+ * one pass instead of reading keys one at a time. Later changes to the
+ * sites are reported through the text_poke tracepoint. Sites in init text
+ * are skipped. The caller must hold a reference on @mod.
+ *
+ * Returns the first non-zero value returned by @fn, or 0.
+ */
+int jump_label_for_each_entry(struct module *mod,
+			      int (*fn)(void *data, unsigned long code,
+					unsigned long target, bool jump),
+			      void *data)
+{
+	struct jump_entry *iter = __start___jump_table;
+	struct jump_entry *stop = __stop___jump_table;
+	int ret = 0;
+
+#ifdef CONFIG_MODULES
+	if (mod) {
+		iter = mod->jump_entries;
+		stop = mod->jump_entries + mod->num_jump_entries;
+	}
+#endif
+
+	jump_label_lock();
+	for (; iter < stop && !ret; iter++) {
+		if (jump_entry_is_init(iter))
+			continue;
+
+		ret = fn(data, jump_entry_code(iter), jump_entry_target(iter),
+			 jump_label_type(iter) == JUMP_LABEL_JMP);
+	}
+	jump_label_unlock();
+
+	return ret;
+}
+EXPORT_SYMBOL_GPL(jump_label_for_each_entry);
+
 static void jump_label_update(struct static_key *key)
 {
 	struct jump_entry *stop = __stop___jump_table;
@@ -742,14 +742,16 @@ static int kimage_load_normal_segment(struct kimage *image,
 		if (result < 0)
 			goto out;
 
-		ptr = kmap_local_page(page);
-		/* Start with a clear page */
-		clear_page(ptr);
-		ptr += maddr & ~PAGE_MASK;
 		mchunk = min_t(size_t, mbytes,
 				PAGE_SIZE - (maddr & ~PAGE_MASK));
 		uchunk = min(ubytes, mchunk);
 
+		ptr = kmap_local_page(page);
+		/* Start with a clear page, unless it is about to be filled */
+		if (uchunk < PAGE_SIZE)
+			clear_page(ptr);
+		ptr += maddr & ~PAGE_MASK;
+
 		if (uchunk) {
 			/* For file based kexec, source pages are in kernel memory */
 			if (image->file_mode)
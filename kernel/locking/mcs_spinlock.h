@@ -17,7 +17,7 @@
 
 struct mcs_spinlock {
 	struct mcs_spinlock *next;
-	int locked; /* 1 if lock acquired */
+	unsigned int locked; /* 1 (or CNA state, see qspinlock_cna.h) if lock acquired */
 	int count;  /* nesting count, see qspinlock.c */
 };
 
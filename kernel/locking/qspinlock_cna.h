@@ -0,0 +1,306 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#ifndef _GEN_CNA_LOCK_SLOWPATH
+#error "do not include this file"
+#endif
+
+#include <linux/topology.h>
+#include <linux/sched/clock.h>
+
+/*
+ * Implement a NUMA-aware version of MCS (aka CNA, or compact NUMA-aware lock).
+ *
+ * In CNA, spinning threads are organized in two queues, a primary queue for
+ * threads running on the same NUMA node as the current lock holder, and a
+ * secondary queue for threads running on other nodes. Schematically, it
+ * looks like this:
+ *
+ *    cna_node
+ *   +----------+     +--------+         +--------+
+ *   |mcs:next  | --> |mcs:next| --> ... |mcs:next| --> NULL  [Primary queue]
+ *   |mcs:locked| -.  +--------+         +--------+
+ *   +----------+  |
+ *                 `----------------------.
+ *                                        v
+ *                 +--------+         +--------+
+ *                 |mcs:next| --> ... |mcs:next|            [Secondary queue]
+ *                 +--------+         +--------+
+ *                     ^                    |
+ *                     `--------------------'
+ *
+ * N.B. locked := 1 if the secondary queue is absent. Otherwise, it contains
+ * the encoded tail of the secondary queue, which is organized as a circular
+ * list so that both its head and its tail are reachable from that one value.
+ *
+ * While the head of the primary queue waits for the lock owner and the
+ * pending bit to go away, it looks for the first waiter behind it that runs
+ * on its own node. The waiters it skips on the way are moved to the tail of
+ * the secondary queue. The MCS lock, together with the secondary queue, is
+ * then passed to that same-node waiter, so the lock and the data it protects
+ * stay on one node for as long as there are local waiters.
+ *
+ * The secondary queue is merged back into the primary queue when the lock is
+ * about to be released with no waiters left in the primary queue, and also
+ * once its oldest waiter has been there for longer than CNA_FLUSH_NS. The
+ * latter bounds how long remote waiters can be starved by a steady stream of
+ * local ones.
+ *
+ * For more details, see https://arxiv.org/abs/1810.05600.
+ */
+
+struct cna_node {
+	struct mcs_spinlock	mcs;
+	u16			numa_node;
+	u32			encoded_tail;	/* self */
+	u64			start_time;	/* when moved to the secondary queue */
+};
+
+/*
+ * Maximum time a waiter may sit in the secondary queue before the whole
+ * queue is handed the lock ahead of the remaining local waiters.
+ */
+#define CNA_FLUSH_NS	(1 * NSEC_PER_MSEC)
+
+static __init void cna_init_nodes(void)
+{
+	unsigned int cpu;
+	int i;
+
+	/*
+	 * The CNA state lives in the qnode padding, which only exists with
+	 * CONFIG_PARAVIRT_SPINLOCKS and is only large enough on 64-bit.
+	 */
+	BUILD_BUG_ON(sizeof(struct cna_node) > sizeof(struct qnode));
+
+	for_each_possible_cpu(cpu) {
+		struct mcs_spinlock *base = per_cpu_ptr(&qnodes[0].mcs, cpu);
+
+		for (i = 0; i < MAX_NODES; i++) {
+			struct cna_node *cn;
+
+			cn = (struct cna_node *)grab_mcs_node(base, i);
+			cn->numa_node = cpu_to_node(cpu);
+			/*
+			 * The encoded tail is stored in @locked, it must not
+			 * be confused with the other valid values (0 or 1).
+			 */
+			cn->encoded_tail = encode_tail(cpu, i);
+			WARN_ON(cn->encoded_tail <= 1);
+		}
+	}
+}
+
+static __always_inline void cna_init_node(struct mcs_spinlock *node)
+{
+	struct cna_node *cn = (struct cna_node *)node;
+
+	/* the node id may have changed if @cpu was hotplugged since boot */
+	cn->numa_node = numa_node_id();
+}
+
+static inline bool cna_secondary_expired(u32 tail_2nd_val)
+{
+	struct mcs_spinlock *head_2nd = decode_tail(tail_2nd_val)->next;
+
+	return local_clock() - ((struct cna_node *)head_2nd)->start_time >
+	       CNA_FLUSH_NS;
+}
+
+/*
+ * cna_splice_tail -- splice the [first, last] segment of the primary queue
+ * onto the tail of the secondary queue owned by @node.
+ */
+static void cna_splice_tail(struct mcs_spinlock *node,
+			    struct mcs_spinlock *first,
+			    struct mcs_spinlock *last)
+{
+	/* remove [first,last] */
+	node->next = last->next;
+
+	/* stick [first,last] on the secondary queue tail */
+	if (node->locked <= 1) { /* if secondary queue is empty */
+		/* create secondary queue */
+		last->next = first;
+		((struct cna_node *)first)->start_time = local_clock();
+	} else {
+		/* add to the tail of the secondary queue */
+		struct mcs_spinlock *tail_2nd = decode_tail(node->locked);
+		struct mcs_spinlock *head_2nd = tail_2nd->next;
+
+		tail_2nd->next = first;
+		last->next = head_2nd;
+	}
+
+	node->locked = ((struct cna_node *)last)->encoded_tail;
+}
+
+/*
+ * cna_order_queue - find the first waiter in the primary queue that runs on
+ * the same node as @node, and move every waiter ahead of it to the secondary
+ * queue.
+ *
+ * Only links that are already published are followed, and the last visible
+ * waiter is never moved, so the lock's tail is left alone. If no same-node
+ * waiter is found, the primary queue is not modified.
+ */
+static void cna_order_queue(struct mcs_spinlock *node)
+{
+	struct mcs_spinlock *first, *last, *next;
+	int numa_node = ((struct cna_node *)node)->numa_node;
+
+	first = READ_ONCE(node->next);
+	if (!first || ((struct cna_node *)first)->numa_node == numa_node)
+		return;
+
+	last = first;
+	while ((next = READ_ONCE(last->next))) {
+		if (((struct cna_node *)next)->numa_node == numa_node) {
+			cna_splice_tail(node, first, last);
+			lockevent_inc(lock_cna_reorder);
+			return;
+		}
+		last = next;
+	}
+}
+
+/*
+ * Called with the MCS lock held, while the lock is still owned or pending. The
+ * time otherwise spent spinning on _Q_LOCKED_PENDING_MASK is used to sort the
+ * queue. A zero return value tells the caller to go and do the actual wait.
+ */
+static __always_inline u32 cna_wait_head_or_lock(struct qspinlock *lock,
+						 struct mcs_spinlock *node)
+{
+	/*
+	 * Once the secondary queue is due to be flushed there is no point in
+	 * growing it further.
+	 */
+	if (node->locked <= 1 || !cna_secondary_expired(node->locked))
+		cna_order_queue(node);
+
+	return 0;
+}
+
+/*
+ * The queue head is the last waiter in the primary queue. Without a secondary
+ * queue this is the plain MCS tail clearing. Otherwise the secondary queue
+ * becomes the primary one: the tail is swung to the secondary queue tail and
+ * the MCS lock is handed to the secondary queue head.
+ */
+static inline bool cna_try_clear_tail(struct qspinlock *lock, u32 val,
+				      struct mcs_spinlock *node)
+{
+	struct mcs_spinlock *head_2nd, *tail_2nd;
+	u32 new;
+
+	/* If the secondary queue is empty, do what MCS does. */
+	if (node->locked <= 1)
+		return __try_clear_tail(lock, val, node);
+
+	tail_2nd = decode_tail(node->locked);
+	head_2nd = tail_2nd->next;
+	new = ((struct cna_node *)tail_2nd)->encoded_tail + _Q_LOCKED_VAL;
+
+	/*
+	 * Break the circular list before @tail_2nd is published as the lock
+	 * tail; a new waiter links itself in via @tail_2nd->next right after
+	 * observing it. The release orders that store before the tail update.
+	 */
+	tail_2nd->next = NULL;
+	if (atomic_try_cmpxchg_release(&lock->val, &val, new)) {
+		arch_mcs_spin_unlock_contended(&head_2nd->locked);
+		return true;
+	}
+
+	/* Someone queued behind us after all, restore the secondary queue. */
+	tail_2nd->next = head_2nd;
+	return false;
+}
+
+/*
+ * Pass the MCS lock, along with the secondary queue, to the next waiter. If
+ * the secondary queue has waited long enough, it is spliced in front of the
+ * primary queue instead and its head gets the MCS lock.
+ */
+static inline void cna_pass_lock(struct mcs_spinlock *node,
+				 struct mcs_spinlock *next)
+{
+	/*
+	 * A queue head that never waited in arch_mcs_spin_lock_contended()
+	 * still has the 0 from the slowpath in @node->locked, and the
+	 * successor spins until its own @locked is non-zero. Only a
+	 * secondary queue tail (> 1) is carried over, otherwise hand over 1.
+	 */
+	u32 val = node->locked > 1 ? node->locked : 1;
+
+	/*
+	 * cna_order_queue() may have changed @node->next after the caller
+	 * loaded @next. The new value is never NULL.
+	 */
+	next = node->next;
+
+	if (val > 1 && cna_secondary_expired(val)) {
+		struct mcs_spinlock *tail_2nd = decode_tail(val);
+		struct mcs_spinlock *head_2nd = tail_2nd->next;
+
+		tail_2nd->next = next;
+		next = head_2nd;
+		val = 1;
+		lockevent_inc(lock_cna_flush);
+	}
+
+	smp_store_release(&next->locked, val);
+}
+
+/*
+ * Constants for the numa_spinlock= boot parameter.
+ */
+enum {
+	NUMA_LOCKS_OFF = -1,
+	NUMA_LOCKS_AUTO,
+	NUMA_LOCKS_ON,
+};
+
+static int numa_spinlock_flag __initdata = NUMA_LOCKS_AUTO;
+
+static int __init numa_spinlock_setup(char *str)
+{
+	if (!str)
+		return -EINVAL;
+
+	if (!strcmp(str, "auto"))
+		numa_spinlock_flag = NUMA_LOCKS_AUTO;
+	else if (!strcmp(str, "on"))
+		numa_spinlock_flag = NUMA_LOCKS_ON;
+	else if (!strcmp(str, "off"))
+		numa_spinlock_flag = NUMA_LOCKS_OFF;
+	else
+		return -EINVAL;
+
+	return 0;
+}
+/* early, as the slow path is picked in smp_prepare_boot_cpu() */
+early_param("numa_spinlock", numa_spinlock_setup);
+
+/*
+ * Switch to the NUMA-friendly slow path for spinlocks when we have multiple
+ * NUMA nodes in native environment, unless the user has overridden this
+ * default behavior by setting the numa_spinlock flag. Paravirt guests
+ * install their own slow path later in boot and take precedence.
+ */
+void __init cna_configure_spin_lock_slowpath(void)
+{
+	if (numa_spinlock_flag == NUMA_LOCKS_OFF)
+		return;
+
+	if (numa_spinlock_flag == NUMA_LOCKS_AUTO &&
+	    (nr_node_ids < 2 || boot_cpu_has(X86_FEATURE_HYPERVISOR) ||
+	     pv_ops.lock.queued_spin_lock_slowpath !=
+			native_queued_spin_lock_slowpath))
+		return;
+
+	cna_init_nodes();
+
+	pv_ops.lock.queued_spin_lock_slowpath = __cna_queued_spin_lock_slowpath;
+
+	pr_info("Enabling CNA spinlock\n");
+}
@@ -741,12 +741,26 @@ rwsem_owner_state(struct task_struct *owner, unsigned long flags)
 	return owner ? OWNER_WRITER : OWNER_NULL;
 }
 
+/*
+ * Maximum time to spin on a single writer owner.
+ *
+ * A writer that stays on-CPU while holding the lock is not necessarily
+ * about to release it; i_rwsem for example can be held across a whole
+ * buffered write. Once a spinner has watched the same writer for this
+ * long, further spinning is unlikely to be cheaper than a sleep/wakeup
+ * cycle, so give up and queue. This is just a heuristic and is subjected
+ * to change in the future.
+ */
+#define RWSEM_WSPIN_MAX_NS	(50 * NSEC_PER_USEC)
+
 static noinline enum owner_state
 rwsem_spin_on_owner(struct rw_semaphore *sem)
 {
 	struct task_struct *new, *owner;
 	unsigned long flags, new_flags;
 	enum owner_state state;
+	u64 wspin_threshold = 0;
+	int loop = 0;
 
 	lockdep_assert_preemption_disabled();
 
@@ -783,6 +797,22 @@ rwsem_spin_on_owner(struct rw_semaphore *sem)
 			break;
 		}
 
+		/*
+		 * As with reader-owned spinning, only look at the clock once
+		 * every 16 iterations.
+		 */
+		if (!(++loop & 0xf)) {
+			u64 now = sched_clock();
+
+			if (!wspin_threshold) {
+				wspin_threshold = now + RWSEM_WSPIN_MAX_NS;
+			} else if (now > wspin_threshold) {
+				lockevent_inc(rwsem_opt_wspin_timeout);
+				state = OWNER_NONSPINNABLE;
+				break;
+			}
+		}
+
 		cpu_relax();
 	}
 
@@ -11,6 +11,7 @@
 #include <linux/slab.h>
 #include <linux/sysfs.h>
 #include <linux/vmalloc.h>
+#include <linux/workqueue.h>
 
 #include "internal.h"
 
@@ -204,18 +205,202 @@ static ssize_t module_xz_decompress(struct load_info *info,
 #define MODULE_COMPRESSION	zstd
 #define MODULE_DECOMPRESS_FN	module_zstd_decompress
 
+/*
+ * Modules made of several zstd frames that all record their decompressed
+ * size are inflated in parallel, one frame at a time per worker, straight
+ * into the final pages. Anything else goes through the streaming decoder.
+ */
+#define MODULE_ZSTD_MAX_WORKERS	8U
+
+/*
+ * The pages for the parallel path are allocated from the sizes in the frame
+ * headers before anything is decompressed. Only trust a header that claims
+ * at most this many bytes per compressed byte, so that a bogus header can't
+ * make us allocate far more than the module could hold; larger frames are
+ * left to the streaming decoder, which allocates as it produces output.
+ */
+#define MODULE_ZSTD_MAX_RATIO	32
+
+struct module_zstd_frame {
+	const void *src;
+	size_t src_size;
+	size_t dst_off;
+	size_t dst_size;
+};
+
+struct module_zstd_ctx {
+	const struct module_zstd_frame *frames;
+	unsigned int nr_frames;
+	atomic_t next;
+	void *dst;
+	int error;
+};
+
+struct module_zstd_work {
+	struct work_struct work;
+	struct module_zstd_ctx *ctx;
+};
+
+/*
+ * Walk the frames of @buf, filling in @frames if it is not NULL. Returns the
+ * number of data frames, or a negative errno. *@known is cleared if any of
+ * them does not record a plausible decompressed size.
+ */
+static int module_zstd_scan_frames(const void *buf, size_t size,
+				   struct module_zstd_frame *frames,
+				   unsigned long long *max_window,
+				   size_t *total, bool *known)
+{
+	zstd_frame_header header;
+	unsigned int nr = 0;
+	size_t csize;
+
+	*max_window = 0;
+	*total = 0;
+	*known = true;
+
+	while (size) {
+		if (zstd_get_frame_header(&header, buf, size) != 0) {
+			pr_err("ZSTD-compressed data has an incomplete frame header\n");
+			return -EINVAL;
+		}
+
+		csize = zstd_find_frame_compressed_size(buf, size);
+		if (zstd_is_error(csize)) {
+			pr_err("ZSTD-compressed data has a corrupted frame\n");
+			return -EINVAL;
+		}
+
+		if (header.frameType != ZSTD_skippableFrame) {
+			if (header.frameContentSize == ZSTD_CONTENTSIZE_UNKNOWN ||
+			    header.frameContentSize / MODULE_ZSTD_MAX_RATIO > csize ||
+			    header.frameContentSize > INT_MAX - *total)
+				*known = false;
+			else
+				*total += header.frameContentSize;
+
+			if (frames) {
+				frames[nr].src = buf;
+				frames[nr].src_size = csize;
+				frames[nr].dst_size = header.frameContentSize;
+				frames[nr].dst_off = nr ? frames[nr - 1].dst_off +
+					frames[nr - 1].dst_size : 0;
+			}
+			*max_window = max(*max_window, header.windowSize);
+			nr++;
+		}
+
+		buf += csize;
+		size -= csize;
+	}
+
+	return nr;
+}
+
+static void module_zstd_decompress_work(struct work_struct *work)
+{
+	struct module_zstd_ctx *ctx =
+		container_of(work, struct module_zstd_work, work)->ctx;
+	size_t wksp_size = zstd_dctx_workspace_bound();
+	const struct module_zstd_frame *f;
+	zstd_dctx *dctx;
+	unsigned int i;
+	void *wksp;
+	size_t ret;
+
+	wksp = kvmalloc(wksp_size, GFP_KERNEL);
+	if (!wksp) {
+		cmpxchg(&ctx->error, 0, -ENOMEM);
+		return;
+	}
+	dctx = zstd_init_dctx(wksp, wksp_size);
+	if (!dctx)
+		cmpxchg(&ctx->error, 0, -ENOMEM);
+
+	while (!READ_ONCE(ctx->error) &&
+	       (i = atomic_fetch_inc(&ctx->next)) < ctx->nr_frames) {
+		f = &ctx->frames[i];
+		ret = zstd_decompress_dctx(dctx, ctx->dst + f->dst_off,
+					   f->dst_size, f->src, f->src_size);
+		if (zstd_is_error(ret) || ret != f->dst_size) {
+			pr_err("ZSTD-decompression of frame %u failed\n", i);
+			cmpxchg(&ctx->error, 0, -EINVAL);
+		}
+	}
+
+	kvfree(wksp);
+}
+
+static ssize_t module_zstd_decompress_frames(struct load_info *info,
+					     const void *buf, size_t size,
+					     unsigned int nr_frames)
+{
+	struct module_zstd_ctx ctx = { .nr_frames = nr_frames };
+	struct module_zstd_frame *frames;
+	struct module_zstd_work *works;
+	unsigned long long max_window;
+	unsigned int i, nr_works;
+	size_t total;
+	bool known;
+	ssize_t retval;
+
+	frames = kvmalloc_array(nr_frames, sizeof(*frames), GFP_KERNEL);
+	nr_works = min3(nr_frames, num_online_cpus(), MODULE_ZSTD_MAX_WORKERS);
+	works = kcalloc(nr_works, sizeof(*works), GFP_KERNEL);
+	if (!frames || !works) {
+		retval = -ENOMEM;
+		goto out;
+	}
+
+	module_zstd_scan_frames(buf, size, frames, &max_window, &total, &known);
+	ctx.frames = frames;
+
+	for (i = 0; i < DIV_ROUND_UP(total, PAGE_SIZE); i++) {
+		struct page *page = module_get_next_page(info);
+
+		if (IS_ERR(page)) {
+			retval = PTR_ERR(page);
+			goto out;
+		}
+	}
+
+	ctx.dst = vmap(info->pages, info->used_pages, VM_MAP, PAGE_KERNEL);
+	if (!ctx.dst) {
+		retval = -ENOMEM;
+		goto out;
+	}
+
+	for (i = 0; i < nr_works; i++) {
+		works[i].ctx = &ctx;
+		INIT_WORK(&works[i].work, module_zstd_decompress_work);
+		queue_work(system_unbound_wq, &works[i].work);
+	}
+	for (i = 0; i < nr_works; i++)
+		flush_work(&works[i].work);
+
+	vunmap(ctx.dst);
+	retval = ctx.error ?: total;
+
+ out:
+	kfree(works);
+	kvfree(frames);
+	return retval;
+}
+
 static ssize_t module_zstd_decompress(struct load_info *info,
 				    const void *buf, size_t size)
 {
 	static const u8 signature[] = { 0x28, 0xb5, 0x2f, 0xfd };
 	ZSTD_outBuffer zstd_dec;
 	ZSTD_inBuffer zstd_buf;
-	zstd_frame_header header;
+	unsigned long long max_window;
 	size_t wksp_size;
 	void *wksp = NULL;
 	ZSTD_DStream *dstream;
-	size_t ret;
+	struct page *page = NULL;
+	size_t ret, total, pos;
 	size_t new_size = 0;
+	bool known;
 	int retval;
 
 	if (size < sizeof(signature) ||
@@ -224,47 +409,50 @@ static ssize_t module_zstd_decompress(struct load_info *info,
 		return -EINVAL;
 	}
 
+	retval = module_zstd_scan_frames(buf, size, NULL, &max_window,
+					 &total, &known);
+	if (retval < 0)
+		return retval;
+	if (max_window > (1 << ZSTD_WINDOWLOG_MAX)) {
+		pr_err("ZSTD-compressed data has too large a window size\n");
+		return -EINVAL;
+	}
+	if (retval > 1 && known && total)
+		return module_zstd_decompress_frames(info, buf, size, retval);
+
 	zstd_buf.src = buf;
 	zstd_buf.pos = 0;
 	zstd_buf.size = size;
 
-	ret = zstd_get_frame_header(&header, zstd_buf.src, zstd_buf.size);
-	if (ret != 0) {
-		pr_err("ZSTD-compressed data has an incomplete frame header\n");
-		retval = -EINVAL;
-		goto out;
-	}
-	if (header.windowSize > (1 << ZSTD_WINDOWLOG_MAX)) {
-		pr_err("ZSTD-compressed data has too large a window size\n");
-		retval = -EINVAL;
-		goto out;
-	}
-
-	wksp_size = zstd_dstream_workspace_bound(header.windowSize);
+	wksp_size = zstd_dstream_workspace_bound(max_window);
 	wksp = kvmalloc(wksp_size, GFP_KERNEL);
 	if (!wksp) {
 		retval = -ENOMEM;
 		goto out;
 	}
 
-	dstream = zstd_init_dstream(header.windowSize, wksp, wksp_size);
+	dstream = zstd_init_dstream(max_window, wksp, wksp_size);
 	if (!dstream) {
 		pr_err("Can't initialize ZSTD stream\n");
 		retval = -ENOMEM;
 		goto out;
 	}
 
+	zstd_dec.size = PAGE_SIZE;
+	zstd_dec.pos = PAGE_SIZE;
 	do {
-		struct page *page = module_get_next_page(info);
-
-		if (IS_ERR(page)) {
-			retval = PTR_ERR(page);
-			goto out;
+		/* Frames end mid-page, only move on once a page is full. */
+		if (zstd_dec.pos == PAGE_SIZE) {
+			page = module_get_next_page(info);
+			if (IS_ERR(page)) {
+				retval = PTR_ERR(page);
+				goto out;
+			}
+			zstd_dec.pos = 0;
 		}
 
 		zstd_dec.dst = kmap_local_page(page);
-		zstd_dec.pos = 0;
-		zstd_dec.size = PAGE_SIZE;
+		pos = zstd_dec.pos;
 
 		ret = zstd_decompress_stream(dstream, &zstd_dec, &zstd_buf);
 		kunmap_local(zstd_dec.dst);
@@ -272,8 +460,9 @@ static ssize_t module_zstd_decompress(struct load_info *info,
 		if (retval)
 			break;
 
-		new_size += zstd_dec.pos;
-	} while (zstd_dec.pos == PAGE_SIZE && ret != 0);
+		new_size += zstd_dec.pos - pos;
+	} while ((zstd_dec.pos == PAGE_SIZE && ret != 0) ||
+		 (ret == 0 && zstd_buf.pos < zstd_buf.size));
 
 	if (retval) {
 		pr_err("ZSTD-decompression failed with status %d\n", retval);
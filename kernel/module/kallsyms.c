@@ -10,6 +10,7 @@
 #include <linux/kallsyms.h>
 #include <linux/buildid.h>
 #include <linux/bsearch.h>
+#include <linux/sort.h>
 #include "internal.h"
 
 /* Lookup exported symbol in given range of kernel_symbols */
@@ -145,6 +146,9 @@ void layout_symtab(struct module *mod, struct load_info *info)
 	/* Note add_kallsyms() computes strtab_size as core_typeoffs - stroffs */
 	info->core_typeoffs = mod_mem_data->size;
 	mod_mem_data->size += ndst * sizeof(char);
+	/* Room for the address-sorted index of the core symbols. */
+	info->core_sortoffs = ALIGN(mod_mem_data->size, __alignof__(unsigned int));
+	mod_mem_data->size = info->core_sortoffs + ndst * sizeof(unsigned int);
 
 	/* Put string table section at end of init part of module. */
 	strsect->sh_flags |= SHF_ALLOC;
@@ -162,6 +166,63 @@ void layout_symtab(struct module *mod, struct load_info *info)
 	mod_mem_init_data->size += nsrc * sizeof(char);
 }
 
+static const char *kallsyms_symbol_name(struct mod_kallsyms *kallsyms, unsigned int symnum)
+{
+	return kallsyms->strtab + kallsyms->symtab[symnum].st_name;
+}
+
+/*
+ * Symbols that can be the answer to an address lookup: defined, and with a
+ * meaningful name (unnamed and mapping symbols are inserted at a whim).
+ * ELF starts real symbols at 1.
+ */
+static bool kallsyms_symbol_addressable(struct mod_kallsyms *kallsyms,
+					unsigned int symnum)
+{
+	const char *name = kallsyms_symbol_name(kallsyms, symnum);
+
+	return symnum && kallsyms->symtab[symnum].st_shndx != SHN_UNDEF &&
+	       *name != '\0' && !is_mapping_symbol(name);
+}
+
+static int kallsyms_addr_cmp(const void *a, const void *b, const void *priv)
+{
+	const struct mod_kallsyms *kallsyms = priv;
+	unsigned int ia = *(const unsigned int *)a, ib = *(const unsigned int *)b;
+	unsigned long va = kallsyms_symbol_value(&kallsyms->symtab[ia]);
+	unsigned long vb = kallsyms_symbol_value(&kallsyms->symtab[ib]);
+
+	/* Aliases keep their symtab order, the first one wins lookups. */
+	if (va != vb)
+		return va < vb ? -1 : 1;
+	return ia < ib ? -1 : ia > ib;
+}
+
+/*
+ * Build the address-sorted index of the core symbols, so that address
+ * lookups after init are a binary search instead of a scan of the whole
+ * symtab. Livepatch modules get their symbol values rewritten when they
+ * are relocated, so they keep using the linear scan.
+ */
+static void sort_core_kallsyms(struct module *mod, const struct load_info *info)
+{
+	struct mod_kallsyms *kallsyms = &mod->core_kallsyms;
+	unsigned int i, n = 0;
+
+	if (is_livepatch_module(mod))
+		return;
+
+	kallsyms->addr_sorted = mod->mem[MOD_DATA].base + info->core_sortoffs;
+	for (i = 0; i < kallsyms->num_symtab; i++) {
+		if (kallsyms_symbol_addressable(kallsyms, i))
+			kallsyms->addr_sorted[n++] = i;
+	}
+	kallsyms->num_addr_sorted = n;
+
+	sort_r(kallsyms->addr_sorted, n, sizeof(*kallsyms->addr_sorted),
+	       kallsyms_addr_cmp, NULL, kallsyms);
+}
+
 /*
  * We use the full symtab and strtab which layout_symtab arranged to
  * be appended to the init section.  Later we switch to the cut-down
@@ -190,6 +251,7 @@ void add_kallsyms(struct module *mod, const struct load_info *info)
 	rcu_dereference(mod->kallsyms)->strtab =
 		(void *)info->sechdrs[info->index.str].sh_addr;
 	rcu_dereference(mod->kallsyms)->typetab = init_data_base + info->init_typeoffs;
+	rcu_dereference(mod->kallsyms)->addr_sorted = NULL;
 
 	/*
 	 * Now populate the cut down core kallsyms for after init
@@ -222,6 +284,7 @@ void add_kallsyms(struct module *mod, const struct load_info *info)
 	}
 	rcu_read_unlock();
 	mod->core_kallsyms.num_symtab = ndst;
+	sort_core_kallsyms(mod, info);
 }
 
 #if IS_ENABLED(CONFIG_STACKTRACE_BUILD_ID)
@@ -244,9 +307,78 @@ void init_build_id(struct module *mod, const struct load_info *info)
 }
 #endif
 
-static const char *kallsyms_symbol_name(struct mod_kallsyms *kallsyms, unsigned int symnum)
+/*
+ * Scan for closest preceding symbol, and next symbol. Returns the symtab index
+ * of the closest preceding symbol, or 0 if there is none.
+ */
+static unsigned int scan_kallsyms_symbol(struct mod_kallsyms *kallsyms,
+					 unsigned long addr,
+					 unsigned long *nextval)
 {
-	return kallsyms->strtab + kallsyms->symtab[symnum].st_name;
+	unsigned int i, best = 0;
+	unsigned long bestval = kallsyms_symbol_value(&kallsyms->symtab[best]);
+
+	for (i = 1; i < kallsyms->num_symtab; i++) {
+		const Elf_Sym *sym = &kallsyms->symtab[i];
+		unsigned long thisval = kallsyms_symbol_value(sym);
+
+		if (!kallsyms_symbol_addressable(kallsyms, i))
+			continue;
+
+		if (thisval <= addr && thisval > bestval) {
+			best = i;
+			bestval = thisval;
+		}
+		if (thisval > addr && thisval < *nextval)
+			*nextval = thisval;
+	}
+
+	return best;
+}
+
+/*
+ * Binary search variant of scan_kallsyms_symbol() for symtabs that have an
+ * address-sorted index.
+ */
+static unsigned int find_sorted_kallsyms_symbol(struct mod_kallsyms *kallsyms,
+						unsigned long addr,
+						unsigned long *nextval)
+{
+	const unsigned int *sorted = kallsyms->addr_sorted;
+	unsigned int low = 0, high = kallsyms->num_addr_sorted, mid, best;
+	unsigned long bestval;
+
+	/* Find the first entry above addr. */
+	while (low < high) {
+		mid = low + (high - low) / 2;
+		if (kallsyms_symbol_value(&kallsyms->symtab[sorted[mid]]) <= addr)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	if (low < kallsyms->num_addr_sorted) {
+		unsigned long val =
+			kallsyms_symbol_value(&kallsyms->symtab[sorted[low]]);
+
+		if (val < *nextval)
+			*nextval = val;
+	}
+	if (!low)
+		return 0;
+
+	/* Step back to the first of any aliases. */
+	best = low - 1;
+	bestval = kallsyms_symbol_value(&kallsyms->symtab[sorted[best]]);
+	while (best &&
+	       kallsyms_symbol_value(&kallsyms->symtab[sorted[best - 1]]) == bestval)
+		best--;
+
+	/* Same as the linear scan, a zero-valued symbol is no match. */
+	if (!bestval)
+		return 0;
+
+	return sorted[best];
 }
 
 /*
@@ -258,7 +390,7 @@ static const char *find_kallsyms_symbol(struct module *mod,
 					unsigned long *size,
 					unsigned long *offset)
 {
-	unsigned int i, best = 0;
+	unsigned int best;
 	unsigned long nextval, bestval;
 	struct mod_kallsyms *kallsyms = rcu_dereference_sched(mod->kallsyms);
 	struct module_memory *mod_mem;
@@ -271,35 +403,12 @@ static const char *find_kallsyms_symbol(struct module *mod,
 
 	nextval = (unsigned long)mod_mem->base + mod_mem->size;
 
+	if (kallsyms->addr_sorted)
+		best = find_sorted_kallsyms_symbol(kallsyms, addr, &nextval);
+	else
+		best = scan_kallsyms_symbol(kallsyms, addr, &nextval);
 	bestval = kallsyms_symbol_value(&kallsyms->symtab[best]);
 
-	/*
-	 * Scan for closest preceding symbol, and next symbol. (ELF
-	 * starts real symbols at 1).
-	 */
-	for (i = 1; i < kallsyms->num_symtab; i++) {
-		const Elf_Sym *sym = &kallsyms->symtab[i];
-		unsigned long thisval = kallsyms_symbol_value(sym);
-
-		if (sym->st_shndx == SHN_UNDEF)
-			continue;
-
-		/*
-		 * We ignore unnamed symbols: they're uninformative
-		 * and inserted at a whim.
-		 */
-		if (*kallsyms_symbol_name(kallsyms, i) == '\0' ||
-		    is_mapping_symbol(kallsyms_symbol_name(kallsyms, i)))
-			continue;
-
-		if (thisval <= addr && thisval > bestval) {
-			best = i;
-			bestval = thisval;
-		}
-		if (thisval > addr && thisval < nextval)
-			nextval = thisval;
-	}
-
 	if (!best)
 		return NULL;
 
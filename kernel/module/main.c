@@ -65,6 +65,8 @@
 #define CREATE_TRACE_POINTS
 #include <trace/events/module.h>
 
+EXPORT_TRACEPOINT_SYMBOL_GPL(module_load);
+
 /*
  * Mutex protects:
  * 1) List of modules (also safely readable with preempt_disable),
@@ -3708,6 +3710,29 @@ struct module *__module_address(unsigned long addr)
 	return mod;
 }
 
+/**
+ * module_get_address() - get a reference on the module containing an address.
+ * @addr: the address.
+ *
+ * Like __module_address(), the lookup goes through the module tree rather
+ * than the module list, but it can be called from any context that may
+ * disable preemption and the module is returned with a reference held.
+ * Returns NULL if no live module contains @addr. Release with module_put().
+ */
+struct module *module_get_address(unsigned long addr)
+{
+	struct module *mod;
+
+	preempt_disable();
+	mod = __module_address(addr);
+	if (mod && !try_module_get(mod))
+		mod = NULL;
+	preempt_enable();
+
+	return mod;
+}
+EXPORT_SYMBOL_GPL(module_get_address);
+
 /**
  * is_module_text_address() - is this address inside module code?
  * @addr: the address to check.
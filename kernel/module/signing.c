@@ -67,6 +67,16 @@ int mod_verify_sig(const void *mod, struct load_info *info)
 				      NULL, NULL);
 }
 
+/*
+ * Check the signature appended to the module image in @info.
+ *
+ * This runs in the context of the task loading the module, before the
+ * module is added to the module list and without module_mutex held, so the
+ * signature checks of concurrent finit_module() calls already proceed in
+ * parallel. It has to complete before layout_and_allocate(): that rewrites
+ * the section headers of the image in place, which would change the data
+ * being hashed.
+ */
 int module_sig_check(struct load_info *info, int flags)
 {
 	int err = -ENODATA;
@@ -281,13 +281,28 @@ static struct padata_priv *padata_find_next(struct parallel_data *pd,
 	return padata;
 }
 
+/* Upper bound on the objects handed to a serial queue at once. */
+#define PADATA_SERIAL_BATCH	16
+
+static void padata_queue_serial(struct parallel_data *pd, int cb_cpu,
+				struct list_head *batch)
+{
+	struct padata_serial_queue *squeue = per_cpu_ptr(pd->squeue, cb_cpu);
+
+	spin_lock(&squeue->serial.lock);
+	list_splice_tail_init(batch, &squeue->serial.list);
+	spin_unlock(&squeue->serial.lock);
+
+	queue_work_on(cb_cpu, pd->ps->pinst->serial_wq, &squeue->work);
+}
+
 static void padata_reorder(struct parallel_data *pd)
 {
 	struct padata_instance *pinst = pd->ps->pinst;
-	int cb_cpu;
 	struct padata_priv *padata;
-	struct padata_serial_queue *squeue;
 	struct padata_list *reorder;
+	LIST_HEAD(batch);
+	int batch_cpu = -1, batch_len = 0;
 
 	/*
 	 * We need to ensure that only one cpu can work on dequeueing of
@@ -313,16 +328,25 @@ static void padata_reorder(struct parallel_data *pd)
 		if (!padata)
 			break;
 
-		cb_cpu = padata->cb_cpu;
-		squeue = per_cpu_ptr(pd->squeue, cb_cpu);
-
-		spin_lock(&squeue->serial.lock);
-		list_add_tail(&padata->list, &squeue->serial.list);
-		spin_unlock(&squeue->serial.lock);
-
-		queue_work_on(cb_cpu, pinst->serial_wq, &squeue->work);
+		/*
+		 * Runs of objects for the same callback CPU are passed to
+		 * its serial queue together, which saves a lock round trip
+		 * and a queue_work_on() per object.
+		 */
+		if (padata->cb_cpu != batch_cpu ||
+		    batch_len == PADATA_SERIAL_BATCH) {
+			if (batch_len)
+				padata_queue_serial(pd, batch_cpu, &batch);
+			batch_cpu = padata->cb_cpu;
+			batch_len = 0;
+		}
+		list_add_tail(&padata->list, &batch);
+		batch_len++;
 	}
 
+	if (batch_len)
+		padata_queue_serial(pd, batch_cpu, &batch);
+
 	spin_unlock_bh(&pd->lock);
 
 	/*
@@ -2549,6 +2549,38 @@ static bool consume_dispatch_q(struct rq *rq, struct scx_dispatch_q *dsq)
 	return false;
 }
 
+/*
+ * Move up to @nr tasks which are already on @rq from @dsq to @rq's local DSQ
+ * in one go. As such moves don't need to drop @dsq->lock, the whole batch costs
+ * a single lock acquisition. Tasks on other rqs are left alone. Returns the
+ * number of tasks moved.
+ */
+static u32 consume_local_tasks(struct rq *rq, struct scx_dispatch_q *dsq,
+			       u32 nr)
+{
+	struct task_struct *p, *next;
+	u32 moved = 0;
+
+	if (list_empty(&dsq->list))
+		return 0;
+
+	raw_spin_lock(&dsq->lock);
+
+	for (p = nldsq_next_task(dsq, NULL, false); p && moved < nr; p = next) {
+		next = nldsq_next_task(dsq, p, false);
+
+		if (task_rq(p) != rq)
+			continue;
+
+		task_unlink_from_dsq(p, dsq);
+		move_local_task_to_local_dsq(p, 0, dsq, rq);
+		moved++;
+	}
+
+	raw_spin_unlock(&dsq->lock);
+	return moved;
+}
+
 static bool consume_global_dsq(struct rq *rq)
 {
 	int node = cpu_to_node(cpu_of(rq));
@@ -6608,6 +6640,53 @@ __bpf_kfunc bool scx_bpf_dsq_move_to_local(u64 dsq_id)
 	}
 }
 
+/**
+ * scx_bpf_dsq_move_to_local_nr - Move a batch of tasks to the local DSQ
+ * @dsq_id: DSQ to move from
+ * @nr: maximum number of tasks to move
+ *
+ * Like scx_bpf_dsq_move_to_local() but moves up to @nr tasks, so that a BPF
+ * scheduler feeding CPUs from a shared DSQ can prefetch several tasks into the
+ * local DSQ per ops.dispatch() invocation. Tasks already on the current CPU's
+ * rq are moved first, in DSQ order and under a single acquisition of the DSQ
+ * lock. If there are none, a single task is migrated from another rq as
+ * scx_bpf_dsq_move_to_local() would. Can only be called from ops.dispatch().
+ *
+ * This function flushes the in-flight dispatches from scx_bpf_dsq_insert()
+ * before trying to move from the specified DSQ. It may also grab rq locks and
+ * thus can't be called under any BPF locks.
+ *
+ * Returns the number of tasks moved.
+ */
+__bpf_kfunc u32 scx_bpf_dsq_move_to_local_nr(u64 dsq_id, u32 nr)
+{
+	struct scx_dsp_ctx *dspc = this_cpu_ptr(scx_dsp_ctx);
+	struct scx_dispatch_q *dsq;
+	u32 moved;
+
+	if (!scx_kf_allowed(SCX_KF_DISPATCH))
+		return 0;
+
+	if (!nr)
+		return 0;
+
+	flush_dispatch_buf(dspc->rq);
+
+	dsq = find_user_dsq(dsq_id);
+	if (unlikely(!dsq)) {
+		scx_ops_error("invalid DSQ ID 0x%016llx", dsq_id);
+		return 0;
+	}
+
+	moved = consume_local_tasks(dspc->rq, dsq, nr);
+	if (!moved && consume_dispatch_q(dspc->rq, dsq))
+		moved = 1;
+
+	/* see scx_bpf_dsq_move_to_local() */
+	dspc->nr_tasks += moved;
+	return moved;
+}
+
 /* for backward compatibility, will be removed in v6.15 */
 __bpf_kfunc bool scx_bpf_consume(u64 dsq_id)
 {
@@ -6749,6 +6828,7 @@ BTF_KFUNCS_START(scx_kfunc_ids_dispatch)
 BTF_ID_FLAGS(func, scx_bpf_dispatch_nr_slots)
 BTF_ID_FLAGS(func, scx_bpf_dispatch_cancel)
 BTF_ID_FLAGS(func, scx_bpf_dsq_move_to_local)
+BTF_ID_FLAGS(func, scx_bpf_dsq_move_to_local_nr)
 BTF_ID_FLAGS(func, scx_bpf_consume)
 BTF_ID_FLAGS(func, scx_bpf_dsq_move_set_slice)
 BTF_ID_FLAGS(func, scx_bpf_dsq_move_set_vtime)
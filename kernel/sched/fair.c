@@ -7161,8 +7161,10 @@ static int dequeue_entities(struct rq *rq, struct sched_entity *se, int flags)
 		dl_server_stop(&rq->fair_server);
 
 	/* balance early to pull high priority tasks */
-	if (unlikely(!was_sched_idle && sched_idle_rq(rq)))
+	if (unlikely(!was_sched_idle && sched_idle_rq(rq))) {
 		rq->next_balance = jiffies;
+		update_idle_cpus(rq);
+	}
 
 	if (p && task_delayed) {
 		SCHED_WARN_ON(!task_sleep);
@@ -7562,6 +7564,59 @@ static inline int __select_idle_cpu(int cpu, struct task_struct *p)
 	return -1;
 }
 
+/*
+ * sd_llc_shared->idle_cpus holds the CPUs of the LLC that select_idle_cpu()
+ * should look at: those that entered idle, or were left running only
+ * SCHED_IDLE tasks, since a scan last found them busy. A bit is set on
+ * those transitions and only cleared by the scan itself, when it probes a
+ * CPU that turned out busy, so that neither leaving idle nor a round trip
+ * through idle that nobody looked at writes to the LLC-wide mask.
+ *
+ * Entering idle is recorded from do_idle(), once rq->curr is the idle task:
+ * setting the bit at pick time would let a scan that runs before the switch
+ * find the CPU busy and clear it for good.
+ */
+void update_idle_cpus(struct rq *rq)
+{
+	struct sched_domain_shared *sds;
+	int cpu = cpu_of(rq);
+
+	if (!sched_feat(SIS_IDLE_MASK))
+		return;
+
+	/*
+	 * Order the state that makes this CPU idle (rq->curr switched to the
+	 * idle task, or the last non-idle task dequeued) before testing the
+	 * bit; pairs with smp_mb__after_atomic() in clear_idle_cpu(). Either
+	 * we see the bit cleared and set it again, or the scan sees us idle
+	 * and does.
+	 */
+	smp_mb();
+
+	rcu_read_lock();
+	sds = rcu_dereference(per_cpu(sd_llc_shared, cpu));
+	if (sds && !cpumask_test_cpu(cpu, to_cpumask(sds->idle_cpus)))
+		cpumask_set_cpu(cpu, to_cpumask(sds->idle_cpus));
+	rcu_read_unlock();
+}
+
+static inline void clear_idle_cpu(struct sched_domain_shared *sds, int cpu)
+{
+	if (!sched_feat(SIS_IDLE_MASK) || !sds ||
+	    available_idle_cpu(cpu) || sched_idle_cpu(cpu))
+		return;
+
+	cpumask_clear_cpu(cpu, to_cpumask(sds->idle_cpus));
+
+	/*
+	 * The CPU may have gone idle since we looked, after its own
+	 * update_idle_cpus() still found the bit set; see there.
+	 */
+	smp_mb__after_atomic();
+	if (available_idle_cpu(cpu) || sched_idle_cpu(cpu))
+		cpumask_set_cpu(cpu, to_cpumask(sds->idle_cpus));
+}
+
 #ifdef CONFIG_SCHED_SMT
 DEFINE_STATIC_KEY_FALSE(sched_smt_present);
 EXPORT_SYMBOL_GPL(sched_smt_present);
@@ -7707,17 +7762,24 @@ static int select_idle_cpu(struct task_struct *p, struct sched_domain *sd, bool
 
 	cpumask_and(cpus, sched_domain_span(sd), p->cpus_ptr);
 
-	if (sched_feat(SIS_UTIL)) {
-		sd_share = rcu_dereference(per_cpu(sd_llc_shared, target));
-		if (sd_share) {
-			/* because !--nr is the condition to stop scan */
-			nr = READ_ONCE(sd_share->nr_idle_scan) + 1;
-			/* overloaded LLC is unlikely to have idle cpu/core */
-			if (nr == 1)
-				return -1;
-		}
+	sd_share = rcu_dereference(per_cpu(sd_llc_shared, target));
+
+	if (sched_feat(SIS_UTIL) && sd_share) {
+		/* because !--nr is the condition to stop scan */
+		nr = READ_ONCE(sd_share->nr_idle_scan) + 1;
+		/* overloaded LLC is unlikely to have idle cpu/core */
+		if (nr == 1)
+			return -1;
 	}
 
+	/*
+	 * Skip CPUs that have not been idle, or SCHED_IDLE only, since they
+	 * were last found busy. An idle core has all of its siblings in the
+	 * mask, so this also holds for the has_idle_core scan.
+	 */
+	if (sched_feat(SIS_IDLE_MASK) && sd_share)
+		cpumask_and(cpus, cpus, to_cpumask(sd_share->idle_cpus));
+
 	if (static_branch_unlikely(&sched_cluster_active)) {
 		struct sched_group *sg = sd->groups;
 
@@ -7736,6 +7798,7 @@ static int select_idle_cpu(struct task_struct *p, struct sched_domain *sd, bool
 					idle_cpu = __select_idle_cpu(cpu, p);
 					if ((unsigned int)idle_cpu < nr_cpumask_bits)
 						return idle_cpu;
+					clear_idle_cpu(sd_share, cpu);
 				}
 			}
 			cpumask_andnot(cpus, cpus, sched_group_span(sg));
@@ -7754,6 +7817,7 @@ static int select_idle_cpu(struct task_struct *p, struct sched_domain *sd, bool
 			idle_cpu = __select_idle_cpu(cpu, p);
 			if ((unsigned int)idle_cpu < nr_cpumask_bits)
 				break;
+			clear_idle_cpu(sd_share, cpu);
 		}
 	}
 
@@ -12104,6 +12168,38 @@ static inline bool update_newidle_cost(struct sched_domain *sd, u64 cost)
 	return false;
 }
 
+/*
+ * Newidle balancing runs on every idle entry and a pull attempt at a large
+ * domain is expensive, yet at some levels it almost never finds anything.
+ * Track, per domain, the fraction of attempts that pulled a task (scaled to
+ * NEWIDLE_WINDOW, over a window of roughly that many attempts) and only
+ * attempt that fraction of the time, but never less than 1 in 16 so the
+ * estimate can recover.
+ */
+#define NEWIDLE_MIN_RATIO	(NEWIDLE_WINDOW / 16)
+
+static inline bool newidle_balance_try(struct sched_domain *sd)
+{
+	sd->newidle_credit += max(sd->newidle_ratio, NEWIDLE_MIN_RATIO);
+	if (sd->newidle_credit < NEWIDLE_WINDOW)
+		return false;
+
+	sd->newidle_credit -= NEWIDLE_WINDOW;
+	return true;
+}
+
+static inline void update_newidle_stats(struct sched_domain *sd, bool success)
+{
+	sd->newidle_call++;
+	sd->newidle_success += success;
+
+	if (sd->newidle_call >= NEWIDLE_WINDOW) {
+		sd->newidle_ratio = sd->newidle_success;
+		sd->newidle_call /= 2;
+		sd->newidle_success /= 2;
+	}
+}
+
 /*
  * It checks each scheduling domain to see if it is due to be balanced,
  * and initiates a balancing operation if so.
@@ -12786,9 +12882,15 @@ static int sched_balance_newidle(struct rq *this_rq, struct rq_flags *rf)
 
 		if (sd->flags & SD_BALANCE_NEWIDLE) {
 
+			if (!newidle_balance_try(sd)) {
+				schedstat_inc(sd->newidle_skipped);
+				continue;
+			}
+
 			pulled_task = sched_balance_rq(this_cpu, this_rq,
 						   sd, CPU_NEWLY_IDLE,
 						   &continue_balancing);
+			update_newidle_stats(sd, pulled_task);
 
 			t1 = sched_clock_cpu(this_cpu);
 			domain_cost = t1 - t0;
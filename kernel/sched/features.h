@@ -78,6 +78,12 @@ SCHED_FEAT(TTWU_QUEUE, true)
  */
 SCHED_FEAT(SIS_UTIL, true)
 
+/*
+ * Only scan the LLC CPUs that went idle, or SCHED_IDLE only, since they were
+ * last found busy, as tracked in sd_llc_shared->idle_cpus.
+ */
+SCHED_FEAT(SIS_IDLE_MASK, true)
+
 /*
  * Issue a WARN when we do multiple update_rq_clock() calls
  * in a single rq->lock section. Default disabled because the
@@ -258,6 +258,9 @@ static void do_idle(void)
 	 */
 	nohz_run_idle_balance(cpu);
 
+	/* Let select_idle_cpu() find us again */
+	update_idle_cpus(this_rq());
+
 	/*
 	 * If the arch has a polling bit, we maintain an invariant:
 	 *
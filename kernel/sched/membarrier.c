@@ -165,6 +165,12 @@
 static DEFINE_MUTEX(membarrier_ipi_mutex);
 #define SERIALIZE_IPI() guard(mutex)(&membarrier_ipi_mutex)
 
+/*
+ * Number of completed MEMBARRIER_CMD_GLOBAL_EXPEDITED IPI rounds. Updated
+ * with membarrier_ipi_mutex held, at the end of each round.
+ */
+static unsigned long membarrier_global_seq;
+
 static void ipi_mb(void *info)
 {
 	smp_mb();	/* IPIs should be serializing but paranoid. */
@@ -249,6 +255,7 @@ static int membarrier_global_expedited(void)
 {
 	int cpu;
 	cpumask_var_t tmpmask;
+	unsigned long seq;
 
 	if (num_online_cpus() == 1)
 		return 0;
@@ -259,10 +266,24 @@ static int membarrier_global_expedited(void)
 	 */
 	smp_mb();	/* system call entry is not a mb. */
 
+	/*
+	 * Concurrent callers are serialized on membarrier_ipi_mutex anyway,
+	 * so let them share IPI rounds: a round which started after our entry
+	 * above provides all the barriers we need. The round in flight when
+	 * @seq is sampled may have started before it, so wait for the one
+	 * after that.
+	 */
+	seq = READ_ONCE(membarrier_global_seq);
+
 	if (!zalloc_cpumask_var(&tmpmask, GFP_KERNEL))
 		return -ENOMEM;
 
 	SERIALIZE_IPI();
+	if (membarrier_global_seq - seq >= 2) {
+		free_cpumask_var(tmpmask);
+		goto done;
+	}
+
 	cpus_read_lock();
 	rcu_read_lock();
 	for_each_online_cpu(cpu) {
@@ -302,6 +323,8 @@ static int membarrier_global_expedited(void)
 	free_cpumask_var(tmpmask);
 	cpus_read_unlock();
 
+	WRITE_ONCE(membarrier_global_seq, membarrier_global_seq + 1);
+done:
 	/*
 	 * Memory barrier on the caller thread _after_ we finished
 	 * waiting for the last IPI. Matches memory barriers before
@@ -188,6 +188,12 @@ extern struct list_head asym_cap_list;
  */
 #define RUNTIME_INF		((u64)~0ULL)
 
+/*
+ * Fixed point scale of sched_domain::newidle_ratio, and the number of newidle
+ * balance attempts it is averaged over.
+ */
+#define NEWIDLE_WINDOW		1024
+
 static inline int idle_policy(int policy)
 {
 	return policy == SCHED_IDLE;
@@ -1560,6 +1566,12 @@ static inline void update_idle_core(struct rq *rq)
 static inline void update_idle_core(struct rq *rq) { }
 #endif
 
+#ifdef CONFIG_SMP
+extern void update_idle_cpus(struct rq *rq);
+#else
+static inline void update_idle_cpus(struct rq *rq) { }
+#endif
+
 #ifdef CONFIG_FAIR_GROUP_SCHED
 
 static inline struct task_struct *task_of(struct sched_entity *se)
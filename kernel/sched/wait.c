@@ -96,6 +96,38 @@ static int __wake_up_common(struct wait_queue_head *wq_head, unsigned int mode,
 	return nr_exclusive;
 }
 
+/*
+ * Wake-all of TASK_NORMAL waiters.  Entries using the stock wake functions
+ * are woken unconditionally here, so rather than calling try_to_wake_up() for
+ * each of them with the queue lock held, collect them on a wake_q and issue
+ * the wakeups once the lock has been dropped.  Other entries are called
+ * in place as usual.
+ *
+ * Exclusive wakeups can't be batched like this, as they need the result of
+ * try_to_wake_up() to decide whether to move on to the next waiter.
+ */
+static void __wake_up_all_batched(struct wait_queue_head *wq_head, void *key)
+{
+	wait_queue_entry_t *curr, *next;
+	unsigned long flags;
+	DEFINE_WAKE_Q(wake_q);
+
+	spin_lock_irqsave(&wq_head->lock, flags);
+	list_for_each_entry_safe(curr, next, &wq_head->head, entry) {
+		if (curr->func == autoremove_wake_function) {
+			wake_q_add(&wake_q, curr->private);
+			list_del_init_careful(&curr->entry);
+		} else if (curr->func == default_wake_function) {
+			wake_q_add(&wake_q, curr->private);
+		} else if (curr->func(curr, TASK_NORMAL, 0, key) < 0) {
+			break;
+		}
+	}
+	spin_unlock_irqrestore(&wq_head->lock, flags);
+
+	wake_up_q(&wake_q);
+}
+
 static int __wake_up_common_lock(struct wait_queue_head *wq_head, unsigned int mode,
 			int nr_exclusive, int wake_flags, void *key)
 {
@@ -124,6 +156,11 @@ static int __wake_up_common_lock(struct wait_queue_head *wq_head, unsigned int m
 int __wake_up(struct wait_queue_head *wq_head, unsigned int mode,
 	      int nr_exclusive, void *key)
 {
+	if (mode == TASK_NORMAL && !nr_exclusive) {
+		__wake_up_all_batched(wq_head, key);
+		return 0;
+	}
+
 	return __wake_up_common_lock(wq_head, mode, nr_exclusive, 0, key);
 }
 EXPORT_SYMBOL(__wake_up);
@@ -471,9 +471,16 @@ asmlinkage __visible void do_softirq(void)
  * The two things to balance is latency against fairness -
  * we want to handle softirqs as soon as possible, but they
  * should not be able to lock up the box.
+ *
+ * On top of that, a single vector which keeps re-raising itself (e.g.
+ * NET_RX under load) may only run MAX_SOFTIRQ_VEC_RESTART times per
+ * invocation. After that it is left pending for ksoftirqd while the
+ * remaining restarts go to the other vectors, so one busy vector can't
+ * use up the whole budget and delay e.g. TIMER or RCU behind it.
  */
 #define MAX_SOFTIRQ_TIME  msecs_to_jiffies(2)
 #define MAX_SOFTIRQ_RESTART 10
+#define MAX_SOFTIRQ_VEC_RESTART (MAX_SOFTIRQ_RESTART / 2)
 
 #ifdef CONFIG_TRACE_IRQFLAGS
 /*
@@ -513,9 +520,10 @@ static void handle_softirqs(bool ksirqd)
 	unsigned long end = jiffies + MAX_SOFTIRQ_TIME;
 	unsigned long old_flags = current->flags;
 	int max_restart = MAX_SOFTIRQ_RESTART;
+	u8 nr_runs[NR_SOFTIRQS] = { };
 	struct softirq_action *h;
+	__u32 pending, deferred = 0;
 	bool in_hardirq;
-	__u32 pending;
 	int softirq_bit;
 
 	/*
@@ -533,7 +541,8 @@ static void handle_softirqs(bool ksirqd)
 
 restart:
 	/* Reset the pending bitmask before enabling irqs */
-	set_softirq_pending(0);
+	set_softirq_pending(pending & deferred);
+	pending &= ~deferred;
 
 	local_irq_enable();
 
@@ -559,6 +568,8 @@ static void handle_softirqs(bool ksirqd)
 			       prev_count, preempt_count());
 			preempt_count_set(prev_count);
 		}
+		if (++nr_runs[vec_nr] >= MAX_SOFTIRQ_VEC_RESTART)
+			deferred |= BIT(vec_nr);
 		h++;
 		pending >>= softirq_bit;
 	}
@@ -570,8 +581,8 @@ static void handle_softirqs(bool ksirqd)
 
 	pending = local_softirq_pending();
 	if (pending) {
-		if (time_before(jiffies, end) && !need_resched() &&
-		    --max_restart)
+		if ((pending & ~deferred) && time_before(jiffies, end) &&
+		    !need_resched() && --max_restart)
 			goto restart;
 
 		wakeup_softirqd();
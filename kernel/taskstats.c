@@ -562,6 +562,59 @@ static int taskstats_user_cmd(struct sk_buff *skb, struct genl_info *info)
 		return -EINVAL;
 }
 
+/*
+ * Dump the per-tgid statistics of every thread group in the caller's pid
+ * namespace, one TASKSTATS_CMD_NEW message per tgid, so that monitoring
+ * agents don't need a request (or a handful of procfs opens) per process.
+ * cb->args[0] holds the next tgid to report.
+ */
+static int taskstats_user_dump(struct sk_buff *skb, struct netlink_callback *cb)
+{
+	struct pid_namespace *ns = task_active_pid_ns(current);
+	pid_t tgid = cb->args[0];
+	struct taskstats *stats;
+	struct pid *pid;
+	bool is_tgid;
+	void *reply;
+
+	for (;; tgid++) {
+		rcu_read_lock();
+		pid = find_ge_pid(tgid, ns);
+		if (pid) {
+			tgid = pid_nr_ns(pid, ns);
+			is_tgid = pid_has_task(pid, PIDTYPE_TGID);
+		}
+		rcu_read_unlock();
+		if (!pid)
+			break;
+		if (!is_tgid)
+			continue;
+
+		reply = genlmsg_put(skb, NETLINK_CB(cb->skb).portid,
+				    cb->nlh->nlmsg_seq, &family, NLM_F_MULTI,
+				    TASKSTATS_CMD_NEW);
+		if (!reply)
+			break;
+
+		stats = mk_reply(skb, TASKSTATS_TYPE_TGID, tgid);
+		if (!stats) {
+			genlmsg_cancel(skb, reply);
+			break;
+		}
+
+		/* The group may have exited since we found its pid */
+		if (fill_stats_for_tgid(tgid, stats) < 0) {
+			genlmsg_cancel(skb, reply);
+			continue;
+		}
+		genlmsg_end(skb, reply);
+		cond_resched();
+	}
+
+	cb->args[0] = tgid;
+	return skb->len;
+}
+
 static struct taskstats *taskstats_tgid_alloc(struct task_struct *tsk)
 {
 	struct signal_struct *sig = tsk->signal;
@@ -662,6 +715,7 @@ static const struct genl_ops taskstats_ops[] = {
 		.cmd		= TASKSTATS_CMD_GET,
 		.validate = GENL_DONT_VALIDATE_STRICT | GENL_DONT_VALIDATE_DUMP,
 		.doit		= taskstats_user_cmd,
+		.dumpit		= taskstats_user_dump,
 		.policy		= taskstats_cmd_get_policy,
 		.maxattr	= ARRAY_SIZE(taskstats_cmd_get_policy) - 1,
 		.flags		= GENL_ADMIN_PERM,
@@ -24,6 +24,7 @@
 #include <linux/percpu.h>
 #include <linux/init.h>
 #include <linux/mm.h>
+#include <linux/prefetch.h>
 #include <linux/swap.h>
 #include <linux/pid_namespace.h>
 #include <linux/notifier.h>
@@ -1826,6 +1827,16 @@ static void expire_timers(struct timer_base *base, struct hlist_head *head)
 		base->running_timer = timer;
 		detach_timer(timer, true);
 
+		/*
+		 * The lock has to be dropped around every callback so that
+		 * timer_delete_sync() can wait for base->running_timer, but the
+		 * next timer on the list can at least be pulled in while the
+		 * callback runs. It's only a hint, the entry may be detached by
+		 * a concurrent timer_delete() in the meantime.
+		 */
+		if (head->first)
+			prefetchw(head->first);
+
 		fn = timer->function;
 
 		if (WARN_ON_ONCE(!fn)) {
@@ -1570,8 +1570,14 @@ ftrace_ops_test(struct ftrace_ops *ops, unsigned long ip, void *regs)
 		return 0;
 #endif
 
-	rcu_assign_pointer(hash.filter_hash, ops->func_hash->filter_hash);
-	rcu_assign_pointer(hash.notrace_hash, ops->func_hash->notrace_hash);
+	/*
+	 * @hash is a local snapshot, it needs no publish ordering. This is
+	 * called for every ops on every traced call in the list function.
+	 */
+	RCU_INIT_POINTER(hash.filter_hash,
+			 rcu_dereference_raw(ops->func_hash->filter_hash));
+	RCU_INIT_POINTER(hash.notrace_hash,
+			 rcu_dereference_raw(ops->func_hash->notrace_hash));
 
 	if (hash_contains_ip(ip, &hash))
 		ret = 1;
@@ -5791,6 +5797,7 @@ ftrace_set_hash(struct ftrace_ops *ops, unsigned char *buf, int len,
 		unsigned long *ips, unsigned int cnt,
 		int remove, int reset, int enable)
 {
+	int size_bits = FTRACE_HASH_DEFAULT_BITS;
 	struct ftrace_hash **orig_hash;
 	struct ftrace_hash *hash;
 	int ret;
@@ -5798,6 +5805,15 @@ ftrace_set_hash(struct ftrace_ops *ops, unsigned char *buf, int len,
 	if (unlikely(ftrace_disabled))
 		return -ENODEV;
 
+	/*
+	 * Bulk address updates (e.g. fprobe attaching to thousands of
+	 * functions) would otherwise pile up long chains in the default
+	 * sized temporary hash while it's being filled.
+	 */
+	if (ips && !remove)
+		size_bits = clamp(fls(cnt / 2), FTRACE_HASH_DEFAULT_BITS,
+				  FTRACE_HASH_MAX_BITS);
+
 	mutex_lock(&ops->func_hash->regex_lock);
 
 	if (enable)
@@ -5806,9 +5822,9 @@ ftrace_set_hash(struct ftrace_ops *ops, unsigned char *buf, int len,
 		orig_hash = &ops->func_hash->notrace_hash;
 
 	if (reset)
-		hash = alloc_ftrace_hash(FTRACE_HASH_DEFAULT_BITS);
+		hash = alloc_ftrace_hash(size_bits);
 	else
-		hash = alloc_and_copy_ftrace_hash(FTRACE_HASH_DEFAULT_BITS, *orig_hash);
+		hash = alloc_and_copy_ftrace_hash(size_bits, *orig_hash);
 
 	if (!hash) {
 		ret = -ENOMEM;
@@ -7024,8 +7040,16 @@ static int ftrace_process_locs(struct module *mod,
 	 * modules can not be sorted at build time.
 	 */
 	if (!IS_ENABLED(CONFIG_BUILDTIME_MCOUNT_SORT) || mod) {
-		sort(start, count, sizeof(*start),
-		     ftrace_cmp_ips, NULL);
+		unsigned long *tmp;
+
+		tmp = kvmalloc_array(count, sizeof(*tmp), GFP_KERNEL);
+		if (tmp) {
+			radix_sort_ul(start, count, tmp);
+			kvfree(tmp);
+		} else {
+			sort(start, count, sizeof(*start),
+			     ftrace_cmp_ips, NULL);
+		}
 	} else {
 		test_is_sorted(start, count);
 	}
@@ -8668,7 +8692,9 @@ static int kallsyms_callback(void *data, const char *name, unsigned long addr)
  * This function looks up addresses for array of symbols provided in
  * @syms array (must be alphabetically sorted) and stores them in
  * @addrs array, which needs to be big enough to store at least @cnt
- * addresses.
+ * addresses. Symbols that cannot be resolved to an ftrace location are
+ * left as 0 in @addrs, so a caller validating a set of probe targets can
+ * drop those and register the rest at once with register_fprobe_ips().
  *
  * Returns: 0 if all provided symbols are found, -ESRCH otherwise.
  */
@@ -8689,6 +8715,7 @@ int ftrace_lookup_symbols(const char **sorted_syms, size_t cnt, unsigned long *a
 	found_all = module_kallsyms_on_each_symbol(NULL, kallsyms_callback, &args);
 	return found_all ? 0 : -ESRCH;
 }
+EXPORT_SYMBOL_GPL(ftrace_lookup_symbols);
 
 #ifdef CONFIG_SYSCTL
 
@@ -3,7 +3,7 @@
 #define __TRACING_MAP_H
 
 #define TRACING_MAP_BITS_DEFAULT	11
-#define TRACING_MAP_BITS_MAX		17
+#define TRACING_MAP_BITS_MAX		20
 #define TRACING_MAP_BITS_MIN		7
 
 #define TRACING_MAP_KEYS_MAX		3
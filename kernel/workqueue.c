@@ -54,6 +54,8 @@
 #include <linux/nmi.h>
 #include <linux/kvm_para.h>
 #include <linux/delay.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 #include <linux/irq_work.h>
 
 #include "workqueue_internal.h"
@@ -1376,6 +1378,176 @@ static void wq_cpu_intensive_report(work_func_t func)
 static void wq_cpu_intensive_report(work_func_t func) {}
 #endif	/* CONFIG_WQ_CPU_INTENSIVE_REPORT */
 
+#ifdef CONFIG_WQ_LATENCY_STATS
+
+/*
+ * Execution time histograms of work functions. Off by default, and a static
+ * branch in process_one_work() when off. Write 1 to <debugfs>/workqueue_latency
+ * to start collecting and read it back for a table of work functions with
+ * their count, total and maximum execution time and a log2 histogram in
+ * microseconds. Bucket 0 counts executions shorter than 1us and bucket N
+ * those in [2^(N-1), 2^N)us, the last bucket absorbs everything longer.
+ *
+ * Like wci_ents[] above, entries are allocated once per work function from
+ * a fixed table and never freed.
+ */
+#define WLS_MAX_ENTS		256
+#define WLS_NR_BUCKETS		20
+
+struct wls_ent {
+	work_func_t		func;
+	atomic64_t		total_ns;
+	atomic64_t		max_ns;
+	atomic64_t		hist[WLS_NR_BUCKETS];
+	struct hlist_node	hash_node;
+};
+
+static DEFINE_STATIC_KEY_FALSE(wq_latency_stats_enabled);
+static struct wls_ent wls_ents[WLS_MAX_ENTS];
+static int wls_nr_ents;
+static DEFINE_RAW_SPINLOCK(wls_lock);
+static DEFINE_HASHTABLE(wls_hash, ilog2(WLS_MAX_ENTS));
+
+static struct wls_ent *wls_find_ent(work_func_t func)
+{
+	struct wls_ent *ent;
+
+	hash_for_each_possible_rcu(wls_hash, ent, hash_node,
+				   (unsigned long)func) {
+		if (ent->func == func)
+			return ent;
+	}
+	return NULL;
+}
+
+static struct wls_ent *wls_get_ent(work_func_t func)
+{
+	struct wls_ent *ent;
+	unsigned long flags;
+
+	ent = wls_find_ent(func);
+	if (likely(ent) || wls_nr_ents >= WLS_MAX_ENTS)
+		return ent;
+
+	raw_spin_lock_irqsave(&wls_lock, flags);
+
+	ent = wls_find_ent(func);
+	if (!ent && wls_nr_ents < WLS_MAX_ENTS) {
+		ent = &wls_ents[wls_nr_ents];
+		ent->func = func;
+		hash_add_rcu(wls_hash, &ent->hash_node, (unsigned long)func);
+		/* readers walk wls_ents[] up to wls_nr_ents locklessly */
+		smp_store_release(&wls_nr_ents, wls_nr_ents + 1);
+	}
+
+	raw_spin_unlock_irqrestore(&wls_lock, flags);
+	return ent;
+}
+
+static void wq_latency_record(work_func_t func, u64 start)
+{
+	u64 ns = local_clock() - start;
+	struct wls_ent *ent;
+	s64 max;
+
+	rcu_read_lock();
+	ent = wls_get_ent(func);
+	if (ent) {
+		atomic64_inc(&ent->hist[min_t(unsigned int,
+					      fls64(div_u64(ns, NSEC_PER_USEC)),
+					      WLS_NR_BUCKETS - 1)]);
+		atomic64_add(ns, &ent->total_ns);
+
+		max = atomic64_read(&ent->max_ns);
+		while (ns > max && !atomic64_try_cmpxchg(&ent->max_ns, &max, ns))
+			;
+	}
+	rcu_read_unlock();
+}
+
+static int wq_latency_show(struct seq_file *m, void *v)
+{
+	int nr = smp_load_acquire(&wls_nr_ents);
+	int i, b;
+
+	seq_printf(m, "# enabled: %d\n",
+		   static_branch_unlikely(&wq_latency_stats_enabled));
+	seq_puts(m, "# function count total_ns max_ns hist_us[<1 <2 <4 ...]\n");
+
+	for (i = 0; i < nr; i++) {
+		struct wls_ent *ent = &wls_ents[i];
+		u64 cnt = 0;
+
+		for (b = 0; b < WLS_NR_BUCKETS; b++)
+			cnt += atomic64_read(&ent->hist[b]);
+
+		seq_printf(m, "%ps %llu %lld %lld", ent->func, cnt,
+			   atomic64_read(&ent->total_ns),
+			   atomic64_read(&ent->max_ns));
+		for (b = 0; b < WLS_NR_BUCKETS; b++)
+			seq_printf(m, " %lld", atomic64_read(&ent->hist[b]));
+		seq_putc(m, '\n');
+	}
+	return 0;
+}
+
+static int wq_latency_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, wq_latency_show, NULL);
+}
+
+static ssize_t wq_latency_write(struct file *file, const char __user *ubuf,
+				size_t count, loff_t *ppos)
+{
+	bool enable;
+	int ret;
+
+	ret = kstrtobool_from_user(ubuf, count, &enable);
+	if (ret)
+		return ret;
+
+	if (enable)
+		static_branch_enable(&wq_latency_stats_enabled);
+	else
+		static_branch_disable(&wq_latency_stats_enabled);
+
+	return count;
+}
+
+static const struct file_operations wq_latency_fops = {
+	.open		= wq_latency_open,
+	.read		= seq_read,
+	.write		= wq_latency_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init wq_latency_debugfs_init(void)
+{
+	debugfs_create_file("workqueue_latency", 0600, NULL, NULL,
+			    &wq_latency_fops);
+	return 0;
+}
+late_initcall(wq_latency_debugfs_init);
+
+static __always_inline u64 wq_latency_start(void)
+{
+	if (static_branch_unlikely(&wq_latency_stats_enabled))
+		return local_clock();
+	return 0;
+}
+
+static __always_inline void wq_latency_end(work_func_t func, u64 start)
+{
+	if (start)
+		wq_latency_record(func, start);
+}
+
+#else	/* CONFIG_WQ_LATENCY_STATS */
+static inline u64 wq_latency_start(void) { return 0; }
+static inline void wq_latency_end(work_func_t func, u64 start) {}
+#endif	/* CONFIG_WQ_LATENCY_STATS */
+
 /**
  * wq_worker_running - a worker is running again
  * @task: task waking up
@@ -3134,6 +3306,7 @@ __acquires(&pool->lock)
 	unsigned long work_data;
 	int lockdep_start_depth, rcu_start_depth;
 	bool bh_draining = pool->flags & POOL_BH_DRAINING;
+	u64 exec_start;
 #ifdef CONFIG_LOCKDEP
 	/*
 	 * It is permissible to free the struct work_struct from
@@ -3226,7 +3399,9 @@ __acquires(&pool->lock)
 	 */
 	lockdep_invariant_state(true);
 	trace_workqueue_execute_start(work);
+	exec_start = wq_latency_start();
 	worker->current_func(work);
+	wq_latency_end(worker->current_func, exec_start);
 	/*
 	 * While we must be careful to not use "work" after this, the trace
 	 * point will only record its address.
@@ -0,0 +1,211 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Timing benchmarks for the primitives kernel integrity scanners are built
+ * on: page-table walks, task list sweeps, kallsyms resolution and per-page
+ * text hashing. Each benchmark runs a fixed amount of work on a synthetic
+ * fixture SCAN_BENCH_ROUNDS times and reports its fastest round, which is
+ * much more stable from run to run than the mean.
+ */
+
+#include <kunit/test.h>
+
+#include <crypto/hash.h>
+#include <linux/kallsyms.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/mm.h>
+#include <linux/module.h>
+#include <linux/sched/signal.h>
+#include <linux/string.h>
+#include <linux/vmalloc.h>
+
+#define SCAN_BENCH_ROUNDS	5
+#define SCAN_BENCH_PAGES	1024
+#define SCAN_BENCH_LOOKUPS	1000
+
+struct scan_bench {
+	u64 best_ns;
+	unsigned long entries;
+};
+
+#define SCAN_BENCH_INIT { .best_ns = U64_MAX }
+
+static void scan_bench_round(struct scan_bench *b, u64 start,
+			     unsigned long entries)
+{
+	u64 ns = ktime_get_ns() - start;
+
+	if (ns < b->best_ns)
+		b->best_ns = ns;
+	b->entries = entries;
+}
+
+static void scan_bench_report(struct kunit *test, const char *what,
+			      const struct scan_bench *b)
+{
+	u64 ns = max_t(u64, b->best_ns, 1);
+	unsigned long entries = max(b->entries, 1UL);
+
+	kunit_info(test, "%s: %lu entries, %llu ns/op, %llu entries/s\n",
+		   what, b->entries, div64_u64(ns, entries),
+		   div64_u64((u64)entries * NSEC_PER_SEC, ns));
+}
+
+static void scan_bench_pgtable_walk(struct kunit *test)
+{
+	struct scan_bench b = SCAN_BENCH_INIT;
+	void *area;
+	int round;
+
+	area = vmalloc(SCAN_BENCH_PAGES * PAGE_SIZE);
+	KUNIT_ASSERT_NOT_NULL(test, area);
+
+	for (round = 0; round < SCAN_BENCH_ROUNDS; round++) {
+		unsigned long i, present = 0;
+		u64 start = ktime_get_ns();
+
+		for (i = 0; i < SCAN_BENCH_PAGES; i++)
+			present += !!vmalloc_to_page(area + i * PAGE_SIZE);
+
+		scan_bench_round(&b, start, SCAN_BENCH_PAGES);
+		KUNIT_EXPECT_EQ(test, present, SCAN_BENCH_PAGES);
+	}
+
+	vfree(area);
+	scan_bench_report(test, "page-table walk", &b);
+}
+
+static void scan_bench_task_sweep(struct kunit *test)
+{
+	struct scan_bench b = SCAN_BENCH_INIT;
+	int round;
+
+	for (round = 0; round < SCAN_BENCH_ROUNDS; round++) {
+		struct task_struct *p;
+		unsigned long tasks = 0;
+		u64 start = ktime_get_ns();
+
+		rcu_read_lock();
+		for_each_process(p)
+			tasks++;
+		rcu_read_unlock();
+
+		scan_bench_round(&b, start, tasks);
+		KUNIT_EXPECT_GT(test, tasks, 0);
+	}
+
+	scan_bench_report(test, "task sweep", &b);
+}
+
+static const char * const scan_bench_syms[] = {
+	"schedule",
+	"vfree",
+	"commit_creds",
+	"do_exit",
+	"kallsyms_lookup_name",
+};
+
+static void scan_bench_kallsyms(struct kunit *test)
+{
+	unsigned long addrs[ARRAY_SIZE(scan_bench_syms)];
+	struct scan_bench name = SCAN_BENCH_INIT, addr = SCAN_BENCH_INIT;
+	char buf[KSYM_SYMBOL_LEN];
+	int round, i, j;
+
+	for (round = 0; round < SCAN_BENCH_ROUNDS; round++) {
+		u64 start = ktime_get_ns();
+
+		for (i = 0; i < SCAN_BENCH_LOOKUPS; i++)
+			for (j = 0; j < ARRAY_SIZE(scan_bench_syms); j++)
+				addrs[j] = kallsyms_lookup_name(scan_bench_syms[j]);
+
+		scan_bench_round(&name, start,
+				 SCAN_BENCH_LOOKUPS * ARRAY_SIZE(scan_bench_syms));
+	}
+
+	for (j = 0; j < ARRAY_SIZE(scan_bench_syms); j++)
+		KUNIT_ASSERT_NE_MSG(test, addrs[j], 0, "%s", scan_bench_syms[j]);
+
+	for (round = 0; round < SCAN_BENCH_ROUNDS; round++) {
+		u64 start = ktime_get_ns();
+
+		for (i = 0; i < SCAN_BENCH_LOOKUPS; i++)
+			for (j = 0; j < ARRAY_SIZE(scan_bench_syms); j++)
+				sprint_symbol_no_offset(buf, addrs[j]);
+
+		scan_bench_round(&addr, start,
+				 SCAN_BENCH_LOOKUPS * ARRAY_SIZE(scan_bench_syms));
+	}
+
+	KUNIT_EXPECT_STREQ(test, buf, scan_bench_syms[j - 1]);
+
+	scan_bench_report(test, "kallsyms name to address", &name);
+	scan_bench_report(test, "kallsyms address to name", &addr);
+}
+
+static void scan_bench_text_hash(struct kunit *test)
+{
+	struct scan_bench b = SCAN_BENCH_INIT;
+	struct crypto_shash *tfm;
+	unsigned int ds;
+	u8 *digests;
+	void *area;
+	int round, err = 0;
+
+	tfm = crypto_alloc_shash("sha256", 0, 0);
+	if (IS_ERR(tfm))
+		kunit_skip(test, "sha256 not available");
+
+	ds = crypto_shash_digestsize(tfm);
+	digests = kunit_kmalloc_array(test, SCAN_BENCH_PAGES, ds, GFP_KERNEL);
+	area = vmalloc(SCAN_BENCH_PAGES * PAGE_SIZE);
+	if (!digests || !area) {
+		vfree(area);
+		crypto_free_shash(tfm);
+		KUNIT_FAIL(test, "out of memory");
+		return;
+	}
+	memset(area, 0xcc, SCAN_BENCH_PAGES * PAGE_SIZE);
+
+	for (round = 0; round < SCAN_BENCH_ROUNDS && !err; round++) {
+		SHASH_DESC_ON_STACK(desc, tfm);
+		unsigned long i;
+		u64 start;
+
+		desc->tfm = tfm;
+		start = ktime_get_ns();
+		for (i = 0; i < SCAN_BENCH_PAGES && !err; i++)
+			err = crypto_shash_digest(desc, area + i * PAGE_SIZE,
+						  PAGE_SIZE, digests + i * ds);
+
+		scan_bench_round(&b, start, SCAN_BENCH_PAGES);
+		shash_desc_zero(desc);
+	}
+
+	KUNIT_EXPECT_EQ(test, err, 0);
+	/* Identical pages must hash the same. */
+	KUNIT_EXPECT_MEMEQ(test, digests, digests + (SCAN_BENCH_PAGES - 1) * ds,
+			   ds);
+
+	vfree(area);
+	crypto_free_shash(tfm);
+	scan_bench_report(test, "per-page sha256", &b);
+}
+
+static struct kunit_case scan_bench_test_cases[] = {
+	KUNIT_CASE_SLOW(scan_bench_pgtable_walk),
+	KUNIT_CASE_SLOW(scan_bench_task_sweep),
+	KUNIT_CASE_SLOW(scan_bench_kallsyms),
+	KUNIT_CASE_SLOW(scan_bench_text_hash),
+	{}
+};
+
+static struct kunit_suite scan_bench_test_suite = {
+	.name = "scan_bench",
+	.test_cases = scan_bench_test_cases,
+};
+
+kunit_test_suites(&scan_bench_test_suite);
+
+MODULE_DESCRIPTION("KUnit benchmarks for kernel integrity scan primitives");
+MODULE_LICENSE("GPL");
@@ -12,7 +12,9 @@
 
 #include <linux/types.h>
 #include <linux/export.h>
+#include <linux/kernel.h>
 #include <linux/sort.h>
+#include <linux/string.h>
 
 /**
  * is_aligned - is this pointer & size okay for word-wide copying?
@@ -300,3 +302,66 @@ void sort(void *base, size_t num, size_t size,
 	return sort_r(base, num, size, _CMP_WRAPPER, SWAP_WRAPPER, &w);
 }
 EXPORT_SYMBOL(sort);
+
+static int cmp_ul(const void *a, const void *b)
+{
+	unsigned long x = *(const unsigned long *)a;
+	unsigned long y = *(const unsigned long *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+/**
+ * radix_sort_ul - sort an array of unsigned longs
+ * @base: pointer to data to sort
+ * @num: number of elements
+ * @tmp: scratch array with room for @num elements
+ *
+ * This function does an LSD radix sort, eight bits per pass, into ascending
+ * order.  Passes over bytes that are equal in all elements, such as the top
+ * bytes of kernel addresses, are skipped, so sorting takes at most
+ * sizeof(long) counting and scatter passes and no comparisons.  For
+ * large arrays of integer keys this is much faster than sort(), at the cost
+ * of the scratch array.  The sort is stable.
+ */
+void radix_sort_ul(unsigned long *base, size_t num, unsigned long *tmp)
+{
+	unsigned int count[256];
+	unsigned long *src = base, *dst = tmp;
+	unsigned int shift;
+	size_t i, pos;
+
+	if (num < 2)
+		return;
+
+	/* the bucket counters are kept small to save stack */
+	if (WARN_ON_ONCE(num > UINT_MAX)) {
+		sort(base, num, sizeof(*base), cmp_ul, NULL);
+		return;
+	}
+
+	for (shift = 0; shift < BITS_PER_LONG; shift += 8) {
+		memset(count, 0, sizeof(count));
+		for (i = 0; i < num; i++)
+			count[(src[i] >> shift) & 0xff]++;
+
+		/* nothing to do if all elements share this byte */
+		if (count[(src[0] >> shift) & 0xff] == num)
+			continue;
+
+		for (i = 0, pos = 0; i < ARRAY_SIZE(count); i++) {
+			unsigned int c = count[i];
+
+			count[i] = pos;
+			pos += c;
+		}
+		for (i = 0; i < num; i++)
+			dst[count[(src[i] >> shift) & 0xff]++] = src[i];
+
+		swap(src, dst);
+	}
+
+	if (src != base)
+		memcpy(base, src, num * sizeof(*base));
+}
+EXPORT_SYMBOL(radix_sort_ul);
@@ -26,6 +26,8 @@
 
 #define MAX_ENTRIES	1000000
 #define TEST_INSERT_FAIL INT_MAX
+/* not a multiple of RHT_LOOKUP_BULK_BATCH, so each call ends on a short batch */
+#define TEST_LOOKUP_BULK	20
 
 static int parm_entries = 50000;
 module_param(parm_entries, int, 0);
@@ -173,6 +175,70 @@ static int __init test_rht_lookup(struct rhashtable *ht, struct test_obj *array,
 	return 0;
 }
 
+/*
+ * Check rhashtable_lookup_bulk() against rhashtable_lookup() for @n keys, in a
+ * table holding all even ids below @limit. Must be called under RCU.
+ */
+static int __init test_rht_lookup_bulk_keys(struct rhashtable *ht,
+					    const struct test_obj_val *vals,
+					    unsigned int n, unsigned int limit)
+{
+	const void *keys[TEST_LOOKUP_BULK];
+	void *objs[TEST_LOOKUP_BULK];
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		keys[i] = &vals[i];
+
+	rhashtable_lookup_bulk(ht, keys, objs, n, test_rht_params);
+
+	for (i = 0; i < n; i++) {
+		bool expected = !(vals[i].id % 2) && vals[i].id < limit;
+		struct test_obj *obj = objs[i];
+
+		if (obj != rhashtable_lookup(ht, &vals[i], test_rht_params)) {
+			pr_warn("Test failed: Bulk lookup of key %u differs from single lookup\n",
+				vals[i].id);
+			return -EINVAL;
+		}
+		if (expected != !!obj) {
+			pr_warn("Test failed: Bulk lookup of key %u %s\n",
+				vals[i].id, obj ? "found unexpected entry" :
+				"found nothing");
+			return -EINVAL;
+		}
+		if (obj && obj->value.id != vals[i].id) {
+			pr_warn("Test failed: Bulk lookup value mismatch %u!=%u\n",
+				obj->value.id, vals[i].id);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+static int __init test_rht_lookup_bulk(struct rhashtable *ht,
+				       unsigned int entries)
+{
+	struct test_obj_val vals[TEST_LOOKUP_BULK] = {};
+	unsigned int i, j, n;
+	int err;
+
+	for (i = 0; i < entries * 2; i += n) {
+		n = min_t(unsigned int, entries * 2 - i, TEST_LOOKUP_BULK);
+		for (j = 0; j < n; j++)
+			vals[j].id = i + j;
+
+		err = test_rht_lookup_bulk_keys(ht, vals, n, entries * 2);
+		if (err)
+			return err;
+
+		cond_resched_rcu();
+	}
+
+	return 0;
+}
+
 static void test_bucket_stats(struct rhashtable *ht, unsigned int entries)
 {
 	unsigned int total = 0, chain_len = 0;
@@ -238,7 +304,10 @@ static s64 __init test_rhashtable(struct rhashtable *ht, struct test_obj *array,
 	test_bucket_stats(ht, entries);
 	rcu_read_lock();
 	test_rht_lookup(ht, array, entries);
+	err = test_rht_lookup_bulk(ht, entries);
 	rcu_read_unlock();
+	if (err)
+		return err;
 
 	test_bucket_stats(ht, entries);
 
@@ -267,6 +336,53 @@ static s64 __init test_rhashtable(struct rhashtable *ht, struct test_obj *array,
 static struct rhashtable ht;
 static struct rhltable rhlt;
 
+/*
+ * Grow a table from its initial size and, whenever a resize is seen in
+ * progress (future_tbl set), check a sample of keys spread over the ids
+ * inserted so far with rhashtable_lookup_bulk().
+ */
+static int __init test_rht_lookup_bulk_resize(struct test_obj *array,
+					      unsigned int entries)
+{
+	struct test_obj_val vals[TEST_LOOKUP_BULK] = {};
+	unsigned int i, j, resizing = 0;
+	struct bucket_table *tbl;
+	int err;
+
+	err = rhashtable_init(&ht, &test_rht_params);
+	if (err)
+		return err;
+
+	for (i = 0; i < entries; i++) {
+		struct test_obj *obj = &array[i];
+
+		obj->value.id = i * 2;
+		err = insert_retry(&ht, obj, test_rht_params);
+		if (err < 0)
+			goto out;
+		err = 0;
+
+		rcu_read_lock();
+		tbl = rht_dereference_rcu(ht.tbl, &ht);
+		if (rht_dereference_rcu(tbl->future_tbl, &ht)) {
+			for (j = 0; j < TEST_LOOKUP_BULK; j++)
+				vals[j].id = j * (i + 1) * 2 / TEST_LOOKUP_BULK;
+			err = test_rht_lookup_bulk_keys(&ht, vals,
+							TEST_LOOKUP_BULK,
+							(i + 1) * 2);
+			resizing++;
+		}
+		rcu_read_unlock();
+		if (err)
+			goto out;
+	}
+
+	pr_info("  Bulk lookup ok, %u checks during resize\n", resizing);
+out:
+	rhashtable_destroy(&ht);
+	return err;
+}
+
 static int __init test_rhltable(unsigned int entries)
 {
 	struct test_obj_rhl *rhl_test_objects;
@@ -728,6 +844,16 @@ static int __init test_rht_init(void)
 		total_time += time;
 	}
 
+	pr_info("Testing bulk lookup while the table grows\n");
+	memset(objs, 0, test_rht_params.max_size * sizeof(struct test_obj));
+	err = test_rht_lookup_bulk_resize(objs, entries);
+	if (err) {
+		vfree(objs);
+		pr_warn("Test failed: bulk lookup during resize returned %d\n",
+			err);
+		return -EINVAL;
+	}
+
 	pr_info("test if its possible to exceed max_size %d: %s\n",
 			test_rht_params.max_size, test_rhashtable_max(objs, entries) == 0 ?
 			"no, ok" : "YES, failed");
@@ -5,6 +5,7 @@
 #include <linux/sort.h>
 #include <linux/slab.h>
 #include <linux/module.h>
+#include <linux/random.h>
 
 /* a simple boot-time regression test */
 
@@ -45,8 +46,71 @@ static void test_sort(struct kunit *test)
 		KUNIT_ASSERT_LE(test, a[i], a[i + 1]);
 }
 
+static int cmpul(const void *a, const void *b)
+{
+	unsigned long x = *(const unsigned long *)a;
+	unsigned long y = *(const unsigned long *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+/* radix sort @a and check the result against sort() */
+static void check_radix_sort_ul(struct kunit *test, unsigned long *a,
+				unsigned long *ref, unsigned long *tmp)
+{
+	int i;
+
+	memcpy(ref, a, TEST_LEN * sizeof(*a));
+	sort(ref, TEST_LEN, sizeof(*ref), cmpul, NULL);
+
+	radix_sort_ul(a, TEST_LEN, tmp);
+
+	for (i = 0; i < TEST_LEN; i++)
+		KUNIT_ASSERT_EQ(test, a[i], ref[i]);
+}
+
+static void test_radix_sort_ul(struct kunit *test)
+{
+	unsigned long *a, *ref, *tmp;
+	int i;
+
+	a = kunit_kmalloc_array(test, TEST_LEN, sizeof(*a), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, a);
+	ref = kunit_kmalloc_array(test, TEST_LEN, sizeof(*ref), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, ref);
+	tmp = kunit_kmalloc_array(test, TEST_LEN, sizeof(*tmp), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, tmp);
+
+	/* random values, every byte pass runs */
+	for (i = 0; i < TEST_LEN; i++)
+		a[i] = get_random_long();
+	check_radix_sort_ul(test, a, ref, tmp);
+
+	/* many duplicates, and identical top bytes as with kernel pointers */
+	for (i = 0; i < TEST_LEN; i++)
+		a[i] = (ULONG_MAX << 16) | get_random_u32_below(50);
+	check_radix_sort_ul(test, a, ref, tmp);
+
+	/* all elements equal, every pass is skipped */
+	for (i = 0; i < TEST_LEN; i++)
+		a[i] = 0x5a5a5a5aUL;
+	check_radix_sort_ul(test, a, ref, tmp);
+
+	/* only byte 1 varies: a single pass, so the result ends up in @tmp */
+	for (i = 0; i < TEST_LEN; i++)
+		a[i] = 0x11220033UL | ((unsigned long)get_random_u8() << 8);
+	check_radix_sort_ul(test, a, ref, tmp);
+
+	/* bytes 0 and 2 vary with byte 1 fixed: two passes, one skipped */
+	for (i = 0; i < TEST_LEN; i++)
+		a[i] = 0x44005500UL | get_random_u8() |
+		       ((unsigned long)get_random_u8() << 16);
+	check_radix_sort_ul(test, a, ref, tmp);
+}
+
 static struct kunit_case sort_test_cases[] = {
 	KUNIT_CASE(test_sort),
+	KUNIT_CASE(test_radix_sort_ul),
 	{}
 };
 
@@ -57,5 +121,5 @@ static struct kunit_suite sort_test_suite = {
 
 kunit_test_suites(&sort_test_suite);
 
-MODULE_DESCRIPTION("sort() KUnit test suite");
+MODULE_DESCRIPTION("sort() and radix_sort_ul() KUnit test suite");
 MODULE_LICENSE("GPL");
@@ -2194,29 +2194,32 @@ static bool kswapd_is_running(pg_data_t *pgdat)
 }
 
 /*
- * A zone's fragmentation score is the external fragmentation wrt to the
- * COMPACTION_HPAGE_ORDER. It returns a value in the range [0, 100].
+ * A zone's fragmentation score is the external fragmentation wrt to
+ * @order, COMPACTION_HPAGE_ORDER unless compaction is driven by demand
+ * for smaller orders. It returns a value in the range [0, 100].
  */
-static unsigned int fragmentation_score_zone(struct zone *zone)
+static unsigned int fragmentation_score_zone(struct zone *zone,
+					     unsigned int order)
 {
-	return extfrag_for_order(zone, COMPACTION_HPAGE_ORDER);
+	return extfrag_for_order(zone, order);
 }
 
 /*
  * A weighted zone's fragmentation score is the external fragmentation
- * wrt to the COMPACTION_HPAGE_ORDER scaled by the zone's size. It
- * returns a value in the range [0, 100].
+ * wrt to @order scaled by the zone's size. It returns a value in the
+ * range [0, 100].
  *
  * The scaling factor ensures that proactive compaction focuses on larger
  * zones like ZONE_NORMAL, rather than smaller, specialized zones like
  * ZONE_DMA32. For smaller zones, the score value remains close to zero,
  * and thus never exceeds the high threshold for proactive compaction.
  */
-static unsigned int fragmentation_score_zone_weighted(struct zone *zone)
+static unsigned int fragmentation_score_zone_weighted(struct zone *zone,
+						      unsigned int order)
 {
 	unsigned long score;
 
-	score = zone->present_pages * fragmentation_score_zone(zone);
+	score = zone->present_pages * fragmentation_score_zone(zone, order);
 	return div64_ul(score, zone->zone_pgdat->node_present_pages + 1);
 }
 
@@ -2227,7 +2230,8 @@ static unsigned int fragmentation_score_zone_weighted(struct zone *zone)
  * the node's score falls below the low threshold, or one of the back-off
  * conditions is met.
  */
-static unsigned int fragmentation_score_node(pg_data_t *pgdat)
+static unsigned int fragmentation_score_node_order(pg_data_t *pgdat,
+						   unsigned int order)
 {
 	unsigned int score = 0;
 	int zoneid;
@@ -2238,12 +2242,17 @@ static unsigned int fragmentation_score_node(pg_data_t *pgdat)
 		zone = &pgdat->node_zones[zoneid];
 		if (!populated_zone(zone))
 			continue;
-		score += fragmentation_score_zone_weighted(zone);
+		score += fragmentation_score_zone_weighted(zone, order);
 	}
 
 	return score;
 }
 
+static unsigned int fragmentation_score_node(pg_data_t *pgdat)
+{
+	return fragmentation_score_node_order(pgdat, COMPACTION_HPAGE_ORDER);
+}
+
 static unsigned int fragmentation_score_wmark(bool low)
 {
 	unsigned int wmark_low;
@@ -2268,6 +2277,57 @@ static bool should_proactive_compact_node(pg_data_t *pgdat)
 	return fragmentation_score_node(pgdat) > wmark_high;
 }
 
+/*
+ * Demand for orders below COMPACTION_HPAGE_ORDER is only worth a compaction
+ * run once the failed allocations add up to at least this many base pages.
+ */
+#define COMPACTION_DEMAND_MIN_PAGES	512
+
+void compaction_record_demand(int nid, int order)
+{
+	pg_data_t *pgdat = NODE_DATA(nid);
+
+	if (order <= 0 || order >= COMPACTION_DEMAND_ORDERS)
+		return;
+
+	/* Racy, it is only a hint */
+	WRITE_ONCE(pgdat->kcompactd_demand[order],
+		   READ_ONCE(pgdat->kcompactd_demand[order]) + 1);
+}
+
+/*
+ * Pick the order that proactive compaction should target, given the
+ * allocation failures recorded since the last check. Each failure is
+ * weighted by the number of base pages the caller had to fall back to, and
+ * the order with the largest weight wins, as long as that weight pays for
+ * a compaction run and the node is fragmented enough at that order that
+ * compaction can help. Returns 0 if no order qualifies.
+ */
+static int kcompactd_demand_order(pg_data_t *pgdat)
+{
+	unsigned int wmark_high = fragmentation_score_wmark(false);
+	unsigned long best_weight = 0;
+	int order, best_order = 0;
+
+	for (order = 1; order < COMPACTION_DEMAND_ORDERS; order++) {
+		unsigned long weight;
+
+		weight = (unsigned long)READ_ONCE(pgdat->kcompactd_demand[order])
+				<< order;
+		WRITE_ONCE(pgdat->kcompactd_demand[order], 0);
+
+		if (weight < COMPACTION_DEMAND_MIN_PAGES || weight <= best_weight)
+			continue;
+		if (fragmentation_score_node_order(pgdat, order) <= wmark_high)
+			continue;
+
+		best_weight = weight;
+		best_order = order;
+	}
+
+	return best_order;
+}
+
 static enum compact_result __compact_finished(struct compact_control *cc)
 {
 	unsigned int order;
@@ -2302,7 +2362,7 @@ static enum compact_result __compact_finished(struct compact_control *cc)
 		if (kswapd_is_running(pgdat))
 			return COMPACT_PARTIAL_SKIPPED;
 
-		score = fragmentation_score_zone(cc->zone);
+		score = fragmentation_score_zone(cc->zone, cc->proactive_order);
 		wmark_low = fragmentation_score_wmark(true);
 
 		if (score > wmark_low)
@@ -2874,9 +2934,11 @@ enum compact_result try_to_compact_pages(gfp_t gfp_mask, unsigned int order,
 }
 
 /*
- * compact_node() - compact all zones within a node
+ * __compact_node() - compact all zones within a node
  * @pgdat: The node page data
  * @proactive: Whether the compaction is proactive
+ * @proactive_order: The order whose fragmentation score proactive
+ *		     compaction works down
  *
  * For proactive compaction, compact till each zone's fragmentation score
  * reaches within proactive compaction thresholds (as determined by the
@@ -2884,7 +2946,8 @@ enum compact_result try_to_compact_pages(gfp_t gfp_mask, unsigned int order,
  * reaching score targets due to various back-off conditions, such as,
  * contention on per-node or per-zone locks.
  */
-static int compact_node(pg_data_t *pgdat, bool proactive)
+static int __compact_node(pg_data_t *pgdat, bool proactive,
+			  int proactive_order)
 {
 	int zoneid;
 	struct zone *zone;
@@ -2895,6 +2958,7 @@ static int compact_node(pg_data_t *pgdat, bool proactive)
 		.whole_zone = true,
 		.gfp_mask = GFP_KERNEL,
 		.proactive_compaction = proactive,
+		.proactive_order = proactive_order,
 	};
 
 	for (zoneid = 0; zoneid < MAX_NR_ZONES; zoneid++) {
@@ -2920,6 +2984,11 @@ static int compact_node(pg_data_t *pgdat, bool proactive)
 	return 0;
 }
 
+static int compact_node(pg_data_t *pgdat, bool proactive)
+{
+	return __compact_node(pgdat, proactive, COMPACTION_HPAGE_ORDER);
+}
+
 /* Compact all zones of all nodes in the system */
 static int compact_nodes(void)
 {
@@ -3214,6 +3283,24 @@ static int kcompactd(void *p)
 			if (unlikely(score >= prev_score))
 				timeout =
 				   default_timeout << COMPACT_MAX_DEFER_SHIFT;
+		} else if (sysctl_compaction_proactiveness &&
+			   !kswapd_is_running(pgdat)) {
+			int order = kcompactd_demand_order(pgdat);
+
+			/*
+			 * The huge page order is fine, but the smaller orders
+			 * that allocations keep failing at are fragmented.
+			 */
+			if (order) {
+				unsigned int prev_score, score;
+
+				prev_score = fragmentation_score_node_order(pgdat, order);
+				__compact_node(pgdat, true, order);
+				score = fragmentation_score_node_order(pgdat, order);
+				if (unlikely(score >= prev_score))
+					timeout =
+					   default_timeout << COMPACT_MAX_DEFER_SHIFT;
+			}
 		}
 		if (unlikely(pgdat->proactive_compact_trigger))
 			pgdat->proactive_compact_trigger = false;
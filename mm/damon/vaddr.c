@@ -396,11 +396,23 @@ static const struct mm_walk_ops damon_mkold_ops = {
 	.walk_lock = PGWALK_RDLOCK,
 };
 
+/* Called with the mmap_lock held for read */
 static void damon_va_mkold(struct mm_struct *mm, unsigned long addr)
 {
-	mmap_read_lock(mm);
 	walk_page_range(mm, addr, addr + 1, &damon_mkold_ops, NULL);
-	mmap_read_unlock(mm);
+}
+
+/*
+ * The access checks of all regions of a target are done under a single
+ * mmap_lock hold, instead of one per region. Step aside for any writer.
+ */
+static void damon_va_yield_mmap_lock(struct mm_struct *mm)
+{
+	if (mmap_lock_is_contended(mm) || need_resched()) {
+		mmap_read_unlock(mm);
+		cond_resched();
+		mmap_read_lock(mm);
+	}
 }
 
 /*
@@ -425,8 +437,12 @@ static void damon_va_prepare_access_checks(struct damon_ctx *ctx)
 		mm = damon_get_mm(t);
 		if (!mm)
 			continue;
-		damon_for_each_region(r, t)
+		mmap_read_lock(mm);
+		damon_for_each_region(r, t) {
 			__damon_va_prepare_access_check(mm, r);
+			damon_va_yield_mmap_lock(mm);
+		}
+		mmap_read_unlock(mm);
 		mmput(mm);
 	}
 }
@@ -540,6 +556,7 @@ static const struct mm_walk_ops damon_young_ops = {
 	.walk_lock = PGWALK_RDLOCK,
 };
 
+/* Called with the mmap_lock held for read */
 static bool damon_va_young(struct mm_struct *mm, unsigned long addr,
 		unsigned long *folio_sz)
 {
@@ -548,9 +565,7 @@ static bool damon_va_young(struct mm_struct *mm, unsigned long addr,
 		.young = false,
 	};
 
-	mmap_read_lock(mm);
 	walk_page_range(mm, addr, addr + 1, &damon_young_ops, &arg);
-	mmap_read_unlock(mm);
 	return arg.young;
 }
 
@@ -597,14 +612,20 @@ static unsigned int damon_va_check_accesses(struct damon_ctx *ctx)
 	damon_for_each_target(t, ctx) {
 		mm = damon_get_mm(t);
 		same_target = false;
+		if (mm)
+			mmap_read_lock(mm);
 		damon_for_each_region(r, t) {
 			__damon_va_check_access(mm, r, same_target,
 					&ctx->attrs);
 			max_nr_accesses = max(r->nr_accesses, max_nr_accesses);
 			same_target = true;
+			if (mm)
+				damon_va_yield_mmap_lock(mm);
 		}
-		if (mm)
+		if (mm) {
+			mmap_read_unlock(mm);
 			mmput(mm);
+		}
 	}
 
 	return max_nr_accesses;
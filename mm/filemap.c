@@ -3542,19 +3542,20 @@ static vm_fault_t filemap_map_folio_range(struct vm_fault *vmf,
 	struct page *page = folio_page(folio, start);
 	unsigned int count = 0;
 	pte_t *old_ptep = vmf->pte;
+	/*
+	 * If there are too many folios that are recently evicted
+	 * in a file, they will probably continue to be evicted.
+	 * In such situation, read-ahead is only a waste of IO.
+	 * Don't decrease mmap_miss in this scenario to make sure
+	 * we can stop read-ahead.
+	 */
+	bool workingset = folio_test_workingset(folio);
 
 	do {
 		if (PageHWPoison(page + count))
 			goto skip;
 
-		/*
-		 * If there are too many folios that are recently evicted
-		 * in a file, they will probably continue to be evicted.
-		 * In such situation, read-ahead is only a waste of IO.
-		 * Don't decrease mmap_miss in this scenario to make sure
-		 * we can stop read-ahead.
-		 */
-		if (!folio_test_workingset(folio))
+		if (!workingset)
 			(*mmap_miss)++;
 
 		/*
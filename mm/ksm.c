@@ -2096,10 +2096,16 @@ static struct ksm_stable_node *stable_tree_insert(struct folio *kfolio)
  *
  * This function does both searching and inserting, because they share
  * the same walking algorithm in an rbtree.
+ *
+ * The tree is ordered by page checksum first, and by page contents only
+ * among items with the same checksum. An item's checksum does not change
+ * while it is in the tree, and comparing checksums spares us looking up
+ * and comparing the tree page of most of the nodes we walk past.
  */
 static
 struct ksm_rmap_item *unstable_tree_search_insert(struct ksm_rmap_item *rmap_item,
 					      struct page *page,
+					      unsigned int checksum,
 					      struct page **tree_pagep)
 {
 	struct rb_node **new;
@@ -2118,6 +2124,15 @@ struct ksm_rmap_item *unstable_tree_search_insert(struct ksm_rmap_item *rmap_ite
 
 		cond_resched();
 		tree_rmap_item = rb_entry(*new, struct ksm_rmap_item, node);
+		parent = *new;
+		if (checksum != tree_rmap_item->oldchecksum) {
+			if (checksum < tree_rmap_item->oldchecksum)
+				new = &parent->rb_left;
+			else
+				new = &parent->rb_right;
+			continue;
+		}
+
 		tree_page = get_mergeable_page(tree_rmap_item);
 		if (!tree_page)
 			return NULL;
@@ -2132,7 +2147,6 @@ struct ksm_rmap_item *unstable_tree_search_insert(struct ksm_rmap_item *rmap_ite
 
 		ret = memcmp_pages(page, tree_page);
 
-		parent = *new;
 		if (ret < 0) {
 			put_page(tree_page);
 			new = &parent->rb_left;
@@ -2154,6 +2168,7 @@ struct ksm_rmap_item *unstable_tree_search_insert(struct ksm_rmap_item *rmap_ite
 		}
 	}
 
+	rmap_item->oldchecksum = checksum;
 	rmap_item->address |= UNSTABLE_FLAG;
 	rmap_item->address |= (ksm_scan.seqnr & SEQNR_MASK);
 	DO_NUMA(rmap_item->nid = nid);
@@ -2288,8 +2303,13 @@ static void cmp_and_merge_page(struct page *page, struct ksm_rmap_item *rmap_ite
 		return;
 	}
 
+	/* A ksm page being migrated had no checksum calculated above */
+	if (stable_node)
+		checksum = calc_checksum(page);
+
 	tree_rmap_item =
-		unstable_tree_search_insert(rmap_item, page, &tree_page);
+		unstable_tree_search_insert(rmap_item, page, checksum,
+					    &tree_page);
 	if (tree_rmap_item) {
 		bool split;
 
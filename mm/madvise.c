@@ -48,6 +48,12 @@ struct madvise_walk_private {
 	bool pageout;
 };
 
+struct madvise_behavior {
+	int behavior;
+	/* Shared across several ranges when their TLB flushes are batched */
+	struct mmu_gather *tlb;
+};
+
 /*
  * Any behaviour which results in changes to the vma->vm_flags needs to
  * take mmap_lock for writing. Others, which simply traverse vmas, need
@@ -848,10 +854,15 @@ static int madvise_free_single_vma(struct vm_area_struct *vma,
  * An interface that causes the system to free clean pages and flush
  * dirty pages is already available as msync(MS_INVALIDATE).
  */
-static long madvise_dontneed_single_vma(struct vm_area_struct *vma,
+static long madvise_dontneed_single_vma(struct madvise_behavior *madv_behavior,
+					struct vm_area_struct *vma,
 					unsigned long start, unsigned long end)
 {
-	zap_page_range_single(vma, start, end - start, NULL);
+	if (madv_behavior->tlb)
+		zap_page_range_single_batched(madv_behavior->tlb, vma, start,
+					      end - start, NULL);
+	else
+		zap_page_range_single(vma, start, end - start, NULL);
 	return 0;
 }
 
@@ -888,8 +899,9 @@ static bool madvise_dontneed_free_valid_vma(struct vm_area_struct *vma,
 static long madvise_dontneed_free(struct vm_area_struct *vma,
 				  struct vm_area_struct **prev,
 				  unsigned long start, unsigned long end,
-				  int behavior)
+				  struct madvise_behavior *madv_behavior)
 {
+	int behavior = madv_behavior->behavior;
 	struct mm_struct *mm = vma->vm_mm;
 
 	*prev = vma;
@@ -932,7 +944,8 @@ static long madvise_dontneed_free(struct vm_area_struct *vma,
 	}
 
 	if (behavior == MADV_DONTNEED || behavior == MADV_DONTNEED_LOCKED)
-		return madvise_dontneed_single_vma(vma, start, end);
+		return madvise_dontneed_single_vma(madv_behavior, vma,
+						   start, end);
 	else if (behavior == MADV_FREE)
 		return madvise_free_single_vma(vma, start, end);
 	else
@@ -1241,8 +1254,10 @@ static long madvise_guard_remove(struct vm_area_struct *vma,
 static int madvise_vma_behavior(struct vm_area_struct *vma,
 				struct vm_area_struct **prev,
 				unsigned long start, unsigned long end,
-				unsigned long behavior)
+				unsigned long arg)
 {
+	struct madvise_behavior *madv_behavior = (struct madvise_behavior *)arg;
+	int behavior = madv_behavior->behavior;
 	int error;
 	struct anon_vma_name *anon_name;
 	unsigned long new_flags = vma->vm_flags;
@@ -1262,7 +1277,8 @@ static int madvise_vma_behavior(struct vm_area_struct *vma,
 	case MADV_FREE:
 	case MADV_DONTNEED:
 	case MADV_DONTNEED_LOCKED:
-		return madvise_dontneed_free(vma, prev, start, end, behavior);
+		return madvise_dontneed_free(vma, prev, start, end,
+					     madv_behavior);
 	case MADV_NORMAL:
 		new_flags = new_flags & ~VM_RAND_READ & ~VM_SEQ_READ;
 		break;
@@ -1560,6 +1576,120 @@ int madvise_set_anon_name(struct mm_struct *mm, unsigned long start,
 				 madvise_vma_anon_name);
 }
 #endif /* CONFIG_ANON_VMA_NAME */
+
+/*
+ * Returns true if there is nothing to do for this request, either because it
+ * is invalid or empty, or because it was handled without the mmap_lock, with
+ * the result in @err.
+ */
+static bool madvise_should_skip(unsigned long start, size_t len_in,
+				int behavior, int *err)
+{
+	unsigned long end;
+	size_t len;
+
+	if (!madvise_behavior_valid(behavior)) {
+		*err = -EINVAL;
+		return true;
+	}
+
+	if (!PAGE_ALIGNED(start)) {
+		*err = -EINVAL;
+		return true;
+	}
+	len = PAGE_ALIGN(len_in);
+
+	/* Check to see whether len was rounded up from small -ve to zero */
+	if (len_in && !len) {
+		*err = -EINVAL;
+		return true;
+	}
+
+	end = start + len;
+	if (end < start) {
+		*err = -EINVAL;
+		return true;
+	}
+
+	if (end == start) {
+		*err = 0;
+		return true;
+	}
+
+#ifdef CONFIG_MEMORY_FAILURE
+	if (behavior == MADV_HWPOISON || behavior == MADV_SOFT_OFFLINE) {
+		*err = madvise_inject_error(behavior, start, start + len_in);
+		return true;
+	}
+#endif
+
+	return false;
+}
+
+static int madvise_lock(struct mm_struct *mm, int behavior)
+{
+	if (madvise_need_mmap_write(behavior)) {
+		if (mmap_write_lock_killable(mm))
+			return -EINTR;
+	} else {
+		mmap_read_lock(mm);
+	}
+	return 0;
+}
+
+static void madvise_unlock(struct mm_struct *mm, int behavior)
+{
+	if (madvise_need_mmap_write(behavior))
+		mmap_write_unlock(mm);
+	else
+		mmap_read_unlock(mm);
+}
+
+/*
+ * Behaviours whose TLB flushes can be deferred to the end of a whole
+ * process_madvise() vector, using a single mmu_gather.
+ */
+static bool madvise_batch_tlb_flush(int behavior)
+{
+	switch (behavior) {
+	case MADV_DONTNEED:
+	case MADV_DONTNEED_LOCKED:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* Must be called with the mmap_lock held, after madvise_should_skip() */
+static int madvise_do_behavior(struct mm_struct *mm, unsigned long start,
+			       size_t len_in,
+			       struct madvise_behavior *madv_behavior)
+{
+	int behavior = madv_behavior->behavior;
+	struct blk_plug plug;
+	unsigned long end;
+	int error;
+
+	start = untagged_addr_remote(mm, start);
+	end = start + PAGE_ALIGN(len_in);
+
+	blk_start_plug(&plug);
+	switch (behavior) {
+	case MADV_POPULATE_READ:
+	case MADV_POPULATE_WRITE:
+		error = madvise_populate(mm, start, end, behavior);
+		break;
+	default:
+		error = madvise_walk_vmas(mm, start, end,
+					  (unsigned long)madv_behavior,
+					  madvise_vma_behavior);
+		break;
+	}
+	blk_finish_plug(&plug);
+
+	return error;
+}
+
 /*
  * The madvise(2) system call.
  *
@@ -1634,63 +1764,17 @@ int madvise_set_anon_name(struct mm_struct *mm, unsigned long start,
  */
 int do_madvise(struct mm_struct *mm, unsigned long start, size_t len_in, int behavior)
 {
-	unsigned long end;
+	struct madvise_behavior madv_behavior = { .behavior = behavior };
 	int error;
-	int write;
-	size_t len;
-	struct blk_plug plug;
 
-	if (!madvise_behavior_valid(behavior))
-		return -EINVAL;
-
-	if (!PAGE_ALIGNED(start))
-		return -EINVAL;
-	len = PAGE_ALIGN(len_in);
-
-	/* Check to see whether len was rounded up from small -ve to zero */
-	if (len_in && !len)
-		return -EINVAL;
-
-	end = start + len;
-	if (end < start)
-		return -EINVAL;
+	if (madvise_should_skip(start, len_in, behavior, &error))
+		return error;
 
-	if (end == start)
-		return 0;
-
-#ifdef CONFIG_MEMORY_FAILURE
-	if (behavior == MADV_HWPOISON || behavior == MADV_SOFT_OFFLINE)
-		return madvise_inject_error(behavior, start, start + len_in);
-#endif
-
-	write = madvise_need_mmap_write(behavior);
-	if (write) {
-		if (mmap_write_lock_killable(mm))
-			return -EINTR;
-	} else {
-		mmap_read_lock(mm);
-	}
-
-	start = untagged_addr_remote(mm, start);
-	end = start + len;
-
-	blk_start_plug(&plug);
-	switch (behavior) {
-	case MADV_POPULATE_READ:
-	case MADV_POPULATE_WRITE:
-		error = madvise_populate(mm, start, end, behavior);
-		break;
-	default:
-		error = madvise_walk_vmas(mm, start, end, behavior,
-					  madvise_vma_behavior);
-		break;
-	}
-	blk_finish_plug(&plug);
-
-	if (write)
-		mmap_write_unlock(mm);
-	else
-		mmap_read_unlock(mm);
+	error = madvise_lock(mm, behavior);
+	if (error)
+		return error;
+	error = madvise_do_behavior(mm, start, len_in, &madv_behavior);
+	madvise_unlock(mm, behavior);
 
 	return error;
 }
@@ -1704,14 +1788,38 @@ SYSCALL_DEFINE3(madvise, unsigned long, start, size_t, len_in, int, behavior)
 static ssize_t vector_madvise(struct mm_struct *mm, struct iov_iter *iter,
 			      int behavior)
 {
+	struct madvise_behavior madv_behavior = { .behavior = behavior };
+	struct mmu_gather tlb;
 	ssize_t ret = 0;
 	size_t total_len;
 
 	total_len = iov_iter_count(iter);
 
+	/*
+	 * Zapping many small ranges would otherwise flush the TLB once per
+	 * range. Do it once for the whole vector, under one mmap_lock hold.
+	 */
+	if (madvise_batch_tlb_flush(behavior)) {
+		ret = madvise_lock(mm, behavior);
+		if (ret)
+			return ret;
+		lru_add_drain();
+		tlb_gather_mmu(&tlb, mm);
+		madv_behavior.tlb = &tlb;
+	}
+
 	while (iov_iter_count(iter)) {
-		ret = do_madvise(mm, (unsigned long)iter_iov_addr(iter),
-				 iter_iov_len(iter), behavior);
+		unsigned long start = (unsigned long)iter_iov_addr(iter);
+		size_t len_in = iter_iov_len(iter);
+		int error;
+
+		if (!madv_behavior.tlb)
+			ret = do_madvise(mm, start, len_in, behavior);
+		else if (madvise_should_skip(start, len_in, behavior, &error))
+			ret = error;
+		else
+			ret = madvise_do_behavior(mm, start, len_in,
+						  &madv_behavior);
 		/*
 		 * An madvise operation is attempting to restart the syscall,
 		 * but we cannot proceed as it would not be correct to repeat
@@ -1734,6 +1842,11 @@ static ssize_t vector_madvise(struct mm_struct *mm, struct iov_iter *iter,
 		iov_iter_advance(iter, iter_iov_len(iter));
 	}
 
+	if (madv_behavior.tlb) {
+		tlb_finish_mmu(&tlb);
+		madvise_unlock(mm, behavior);
+	}
+
 	ret = (total_len - iov_iter_count(iter)) ? : ret;
 
 	return ret;
@@ -518,6 +518,9 @@ struct memcg_vmstats {
 
 	/* Stats updates since the last flush */
 	atomic64_t		stats_updates;
+
+	/* jiffies_64 at the start of the last flush of this subtree */
+	u64			flush_time;
 };
 
 /*
@@ -540,6 +543,8 @@ static DECLARE_DEFERRABLE_WORK(stats_flush_dwork, flush_memcg_stats_dwork);
 static u64 flush_last_time;
 
 #define FLUSH_TIME (2UL*HZ)
+/* How stale the stats a stat file reader gets are allowed to be */
+#define FLUSH_READER_TIME (HZ/10)
 
 /*
  * Accessors to ensure that preemption is disabled on PREEMPT_RT because it can
@@ -601,6 +606,7 @@ static inline void memcg_rstat_updated(struct mem_cgroup *memcg, int val)
 static void __mem_cgroup_flush_stats(struct mem_cgroup *memcg, bool force)
 {
 	bool needs_flush = memcg_vmstats_needs_flush(memcg->vmstats);
+	u64 now;
 
 	trace_memcg_flush_stats(memcg, atomic64_read(&memcg->vmstats->stats_updates),
 		force, needs_flush);
@@ -608,10 +614,12 @@ static void __mem_cgroup_flush_stats(struct mem_cgroup *memcg, bool force)
 	if (!force && !needs_flush)
 		return;
 
+	now = jiffies_64;
 	if (mem_cgroup_is_root(memcg))
-		WRITE_ONCE(flush_last_time, jiffies_64);
+		WRITE_ONCE(flush_last_time, now);
 
 	cgroup_rstat_flush(memcg->css.cgroup);
+	WRITE_ONCE(memcg->vmstats->flush_time, now);
 }
 
 /*
@@ -641,6 +649,37 @@ void mem_cgroup_flush_stats_ratelimited(struct mem_cgroup *memcg)
 		mem_cgroup_flush_stats(memcg);
 }
 
+/*
+ * mem_cgroup_flush_stats_reader - flush the stats for a stat file reader
+ * @memcg: memory cgroup whose stats are about to be read
+ *
+ * Stat file readers can tolerate stats that are a little stale. If @memcg or
+ * any of its ancestors has had its subtree flushed within FLUSH_READER_TIME,
+ * the stats of @memcg are fresh enough and the flush is skipped. This keeps
+ * monitoring agents that read the stats of thousands of cgroups in a row from
+ * serializing on the rstat lock one cgroup at a time.
+ */
+void mem_cgroup_flush_stats_reader(struct mem_cgroup *memcg)
+{
+	struct mem_cgroup *iter;
+	u64 now = jiffies_64;
+
+	if (mem_cgroup_disabled())
+		return;
+
+	if (!memcg)
+		memcg = root_mem_cgroup;
+
+	for (iter = memcg; iter; iter = parent_mem_cgroup(iter)) {
+		u64 flush_time = READ_ONCE(iter->vmstats->flush_time);
+
+		if (flush_time && time_before64(now, flush_time + FLUSH_READER_TIME))
+			return;
+	}
+
+	__mem_cgroup_flush_stats(memcg, false);
+}
+
 static void flush_memcg_stats_dwork(struct work_struct *w)
 {
 	/*
@@ -1462,7 +1501,7 @@ static void memcg_stat_format(struct mem_cgroup *memcg, struct seq_buf *s)
 	 *
 	 * Current memory state:
 	 */
-	mem_cgroup_flush_stats(memcg);
+	mem_cgroup_flush_stats_reader(memcg);
 
 	for (i = 0; i < ARRAY_SIZE(memory_stats); i++) {
 		u64 size;
@@ -4242,7 +4281,7 @@ static int memory_numa_stat_show(struct seq_file *m, void *v)
 	int i;
 	struct mem_cgroup *memcg = mem_cgroup_from_seq(m);
 
-	mem_cgroup_flush_stats(memcg);
+	mem_cgroup_flush_stats_reader(memcg);
 
 	for (i = 0; i < ARRAY_SIZE(memory_stats); i++) {
 		int nid;
@@ -66,6 +66,7 @@
 #include <linux/gfp.h>
 #include <linux/migrate.h>
 #include <linux/string.h>
+#include <linux/sizes.h>
 #include <linux/memory-tiers.h>
 #include <linux/debugfs.h>
 #include <linux/userfaultfd_k.h>
@@ -76,6 +77,7 @@
 #include <linux/ptrace.h>
 #include <linux/vmalloc.h>
 #include <linux/sched/sysctl.h>
+#include <linux/compaction.h>
 
 #include <trace/events/kmem.h>
 
@@ -1919,37 +1921,281 @@ void unmap_vmas(struct mmu_gather *tlb, struct ma_state *mas,
 	mmu_notifier_invalidate_range_end(&range);
 }
 
+/*
+ * Tearing down a very large address space at exit is spread over unbound
+ * workers.  Once the last user is gone nothing can fault new pages in, and
+ * disjoint ranges can be zapped concurrently just as concurrent
+ * MADV_DONTNEED calls do: the page table locks serialise the rest.
+ *
+ * This may run in reclaim's way, so nothing here waits on memory: work
+ * items are allocated without reclaim, and the exiting task takes back
+ * whatever no worker has picked up yet instead of waiting for a worker.
+ */
+#define EXIT_UNMAP_MIN_PAGES	(SZ_4G >> PAGE_SHIFT)
+#define EXIT_UNMAP_CHUNK_SIZE	SZ_1G
+#define EXIT_UNMAP_MAX_RANGES	16
+
+struct exit_unmap_ctl {
+	struct mm_struct	*mm;
+	struct list_head	works;
+	atomic_t		pending;
+	struct completion	done;
+};
+
+struct exit_unmap_work {
+	struct work_struct	work;
+	struct list_head	node;
+	struct exit_unmap_ctl	*ctl;
+	unsigned long		size;
+	unsigned int		nr;
+	struct {
+		struct vm_area_struct	*vma;
+		unsigned long		start;
+		unsigned long		end;
+	} range[EXIT_UNMAP_MAX_RANGES];
+};
+
+static void exit_unmap_run(struct mmu_gather *tlb, struct exit_unmap_work *w)
+{
+	struct zap_details details = {
+		.zap_flags = ZAP_FLAG_DROP_MARKER | ZAP_FLAG_UNMAP,
+		.even_cows = true,
+	};
+	unsigned int i;
+
+	for (i = 0; i < w->nr; i++)
+		unmap_single_vma(tlb, w->range[i].vma, w->range[i].start,
+				 w->range[i].end, &details, false);
+}
+
+static void exit_unmap_workfn(struct work_struct *work)
+{
+	struct exit_unmap_work *w =
+		container_of(work, struct exit_unmap_work, work);
+	struct exit_unmap_ctl *ctl = w->ctl;
+	struct mmu_gather tlb;
+
+	tlb_gather_mmu_fullmm(&tlb, ctl->mm);
+	exit_unmap_run(&tlb, w);
+	tlb_finish_mmu(&tlb);
+
+	if (atomic_dec_and_test(&ctl->pending))
+		complete(&ctl->done);
+}
+
+static void exit_unmap_queue(struct exit_unmap_work *w)
+{
+	list_add_tail(&w->node, &w->ctl->works);
+	atomic_inc(&w->ctl->pending);
+	queue_work(system_unbound_wq, &w->work);
+}
+
+/*
+ * Hugetlb and VM_PFNMAP vmas need hugetlb_zap_begin() and untrack_pfn(),
+ * and DAX vmas can hold PUD mappings whose zap may want to split under the
+ * mmap_lock, which the workers don't hold; all of those stay with the
+ * exiting task.
+ */
+static bool exit_unmap_can_split(struct vm_area_struct *vma)
+{
+	return !is_vm_hugetlb_page(vma) && !(vma->vm_flags & VM_PFNMAP) &&
+	       !vma_is_dax(vma);
+}
+
+/*
+ * Chunks end on a PUD boundary, so that no huge PMD or PUD mapping is ever
+ * cut in two by a chunk boundary and split just to be zapped.
+ */
+static unsigned long exit_unmap_chunk_end(struct vm_area_struct *vma,
+					  unsigned long start)
+{
+	unsigned long size = round_up(EXIT_UNMAP_CHUNK_SIZE, PUD_SIZE);
+	unsigned long end = ALIGN(start + 1, PUD_SIZE) + size - PUD_SIZE;
+
+	/* end <= start if rounding up wrapped at the top of the space */
+	if (end <= start || end > vma->vm_end)
+		return vma->vm_end;
+	return end;
+}
+
+static bool exit_unmap_parallel(struct mm_struct *mm)
+{
+	if (get_mm_rss(mm) < EXIT_UNMAP_MIN_PAGES || num_online_cpus() == 1)
+		return false;
+	/*
+	 * An OOM victim or an mm the reaper has been at is torn down while
+	 * the system is short of memory; keep that on the exiting task.
+	 */
+	if (tsk_is_oom_victim(current) || test_bit(MMF_OOM_SKIP, &mm->flags) ||
+	    test_bit(MMF_UNSTABLE, &mm->flags))
+		return false;
+	return true;
+}
+
 /**
- * zap_page_range_single - remove user pages in a given range
+ * unmap_vmas_exit - unmap every vma of an mm that has no users left
+ * @tlb: address of the caller's fullmm struct mmu_gather
+ * @mas: the maple state
+ * @vma: the first vma
+ *
+ * Equivalent to unmap_vmas() over the whole address space.  When the mm is
+ * big enough, ranges of ordinary vmas are handed to workers, each with its
+ * own fullmm gather, while hugetlb, VM_PFNMAP and DAX vmas, and anything
+ * that could not be handed off, are unmapped here through @tlb.  Once
+ * everything is queued, ranges no worker has started yet are taken back and
+ * unmapped here as well, so the caller only ever waits for work that is
+ * running.
+ * All ranges are unmapped when this returns, so the caller can go on to
+ * free_pgtables().
+ *
+ * Must be called with the mmap_lock held for read, from exit_mmap().
+ */
+void unmap_vmas_exit(struct mmu_gather *tlb, struct ma_state *mas,
+		struct vm_area_struct *vma)
+{
+	struct mm_struct *mm = vma->vm_mm;
+	struct zap_details details = {
+		.zap_flags = ZAP_FLAG_DROP_MARKER | ZAP_FLAG_UNMAP,
+		/* Careful - we need to zap private pages too! */
+		.even_cows = true,
+	};
+	struct exit_unmap_work *w = NULL, *tmp;
+	struct mmu_notifier_range range;
+	struct exit_unmap_ctl ctl;
+
+	if (!exit_unmap_parallel(mm)) {
+		unmap_vmas(tlb, mas, vma, 0, ULONG_MAX, ULONG_MAX, false);
+		return;
+	}
+
+	ctl.mm = mm;
+	INIT_LIST_HEAD(&ctl.works);
+	atomic_set(&ctl.pending, 1);
+	init_completion(&ctl.done);
+
+	mmu_notifier_range_init(&range, MMU_NOTIFY_UNMAP, 0, mm, 0, ULONG_MAX);
+	mmu_notifier_invalidate_range_start(&range);
+	do {
+		unsigned long start, end;
+
+		if (unlikely(!exit_unmap_can_split(vma))) {
+			start = 0;
+			end = ULONG_MAX;
+			hugetlb_zap_begin(vma, &start, &end);
+			unmap_single_vma(tlb, vma, start, end, &details, false);
+			hugetlb_zap_end(vma, &details);
+			goto next;
+		}
+
+		for (start = vma->vm_start; start < vma->vm_end; start = end) {
+			end = exit_unmap_chunk_end(vma, start);
+
+			if (!w) {
+				w = kmalloc(sizeof(*w), GFP_NOWAIT | __GFP_NOWARN);
+				if (!w) {
+					unmap_single_vma(tlb, vma, start, end,
+							 &details, false);
+					continue;
+				}
+				INIT_WORK(&w->work, exit_unmap_workfn);
+				w->ctl = &ctl;
+				w->size = 0;
+				w->nr = 0;
+			}
+
+			w->range[w->nr].vma = vma;
+			w->range[w->nr].start = start;
+			w->range[w->nr].end = end;
+			w->size += end - start;
+			if (++w->nr == EXIT_UNMAP_MAX_RANGES ||
+			    w->size >= EXIT_UNMAP_CHUNK_SIZE) {
+				exit_unmap_queue(w);
+				w = NULL;
+			}
+		}
+next:
+		vma = mas_find(mas, ULONG_MAX - 1);
+	} while (vma && likely(!xa_is_zero(vma)));
+
+	if (w)
+		exit_unmap_queue(w);
+
+	/* Do whatever the workers have not got to ourselves */
+	list_for_each_entry(w, &ctl.works, node) {
+		if (!cancel_work(&w->work))
+			continue;
+		exit_unmap_run(tlb, w);
+		atomic_dec(&ctl.pending);
+		cond_resched();
+	}
+	if (!atomic_dec_and_test(&ctl.pending))
+		wait_for_completion(&ctl.done);
+	mmu_notifier_invalidate_range_end(&range);
+
+	list_for_each_entry_safe(w, tmp, &ctl.works, node)
+		kfree(w);
+}
+
+/**
+ * zap_page_range_single_batched - remove user pages in a given range
+ * @tlb: pointer to the caller's struct mmu_gather
  * @vma: vm_area_struct holding the applicable pages
- * @address: starting address of pages to zap
- * @size: number of bytes to zap
+ * @address: starting address of pages to remove
+ * @size: number of bytes to remove
  * @details: details of shared cache invalidation
  *
- * The range must fit into one VMA.
+ * @tlb shouldn't be NULL.  The range must fit into one VMA.  If @vma is for
+ * hugetlb, @tlb is flushed and re-initialized by this function.
  */
-void zap_page_range_single(struct vm_area_struct *vma, unsigned long address,
+void zap_page_range_single_batched(struct mmu_gather *tlb,
+		struct vm_area_struct *vma, unsigned long address,
 		unsigned long size, struct zap_details *details)
 {
 	const unsigned long end = address + size;
 	struct mmu_notifier_range range;
-	struct mmu_gather tlb;
 
-	lru_add_drain();
+	VM_WARN_ON_ONCE(!tlb || tlb->mm != vma->vm_mm);
+
 	mmu_notifier_range_init(&range, MMU_NOTIFY_CLEAR, 0, vma->vm_mm,
 				address, end);
 	hugetlb_zap_begin(vma, &range.start, &range.end);
-	tlb_gather_mmu(&tlb, vma->vm_mm);
 	update_hiwater_rss(vma->vm_mm);
 	mmu_notifier_invalidate_range_start(&range);
 	/*
 	 * unmap 'address-end' not 'range.start-range.end' as range
 	 * could have been expanded for hugetlb pmd sharing.
 	 */
-	unmap_single_vma(&tlb, vma, address, end, details, false);
+	unmap_single_vma(tlb, vma, address, end, details, false);
 	mmu_notifier_invalidate_range_end(&range);
+	if (is_vm_hugetlb_page(vma)) {
+		/*
+		 * Flush the TLB and free the pages before hugetlb_zap_end(),
+		 * so concurrent faults don't fail to allocate a huge page.
+		 */
+		tlb_finish_mmu(tlb);
+		hugetlb_zap_end(vma, details);
+		tlb_gather_mmu(tlb, vma->vm_mm);
+	}
+}
+
+/**
+ * zap_page_range_single - remove user pages in a given range
+ * @vma: vm_area_struct holding the applicable pages
+ * @address: starting address of pages to zap
+ * @size: number of bytes to zap
+ * @details: details of shared cache invalidation
+ *
+ * The range must fit into one VMA.
+ */
+void zap_page_range_single(struct vm_area_struct *vma, unsigned long address,
+		unsigned long size, struct zap_details *details)
+{
+	struct mmu_gather tlb;
+
+	lru_add_drain();
+	tlb_gather_mmu(&tlb, vma->vm_mm);
+	zap_page_range_single_batched(&tlb, vma, address, size, details);
 	tlb_finish_mmu(&tlb);
-	hugetlb_zap_end(vma, details);
 }
 
 /**
@@ -4742,6 +4988,7 @@ static struct folio *alloc_anon_folio(struct vm_fault *vmf)
 				folio_zero_user(folio, vmf->address);
 			return folio;
 		}
+		compaction_record_demand(numa_node_id(), order);
 next:
 		count_mthp_stat(order, MTHP_STAT_ANON_FAULT_FALLBACK);
 		order = next_order(&orders, order);
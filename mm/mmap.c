@@ -1663,8 +1663,8 @@ void exit_mmap(struct mm_struct *mm)
 	flush_cache_mm(mm);
 	tlb_gather_mmu_fullmm(&tlb, mm);
 	/* update_hiwater_rss(mm) here? but nobody should be looking */
-	/* Use ULONG_MAX here to ensure all VMAs in the mm are unmapped */
-	unmap_vmas(&tlb, &vmi.mas, vma, 0, ULONG_MAX, ULONG_MAX, false);
+	/* Unmaps all VMAs in the mm, in parallel if the mm is large */
+	unmap_vmas_exit(&tlb, &vmi.mas, vma);
 	mmap_read_unlock(mm);
 
 	/*
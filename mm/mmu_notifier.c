@@ -21,7 +21,14 @@
 
 #include "vma.h"
 
-/* global SRCU for all MMs */
+/*
+ * global SRCU for all MMs
+ *
+ * Readers run on every invalidation and access-bit query of an mm with
+ * subscribers (KVM in particular), always from contexts where RCU is
+ * watching, so they use the smp_mb()-free srcu_read_lock_lite() flavor.
+ * Every reader of this srcu_struct must use that flavor.
+ */
 DEFINE_STATIC_SRCU(srcu);
 
 #ifdef CONFIG_LOCKDEP
@@ -308,7 +315,7 @@ static void mn_hlist_release(struct mmu_notifier_subscriptions *subscriptions,
 	 * SRCU here will block mmu_notifier_unregister until
 	 * ->release returns.
 	 */
-	id = srcu_read_lock(&srcu);
+	id = srcu_read_lock_lite(&srcu);
 	hlist_for_each_entry_rcu(subscription, &subscriptions->list, hlist,
 				 srcu_read_lock_held(&srcu))
 		/*
@@ -333,7 +340,7 @@ static void mn_hlist_release(struct mmu_notifier_subscriptions *subscriptions,
 		hlist_del_init_rcu(&subscription->hlist);
 	}
 	spin_unlock(&subscriptions->lock);
-	srcu_read_unlock(&srcu, id);
+	srcu_read_unlock_lite(&srcu, id);
 
 	/*
 	 * synchronize_srcu here prevents mmu_notifier_release from returning to
@@ -371,7 +378,7 @@ int __mmu_notifier_clear_flush_young(struct mm_struct *mm,
 	struct mmu_notifier *subscription;
 	int young = 0, id;
 
-	id = srcu_read_lock(&srcu);
+	id = srcu_read_lock_lite(&srcu);
 	hlist_for_each_entry_rcu(subscription,
 				 &mm->notifier_subscriptions->list, hlist,
 				 srcu_read_lock_held(&srcu)) {
@@ -379,7 +386,7 @@ int __mmu_notifier_clear_flush_young(struct mm_struct *mm,
 			young |= subscription->ops->clear_flush_young(
 				subscription, mm, start, end);
 	}
-	srcu_read_unlock(&srcu, id);
+	srcu_read_unlock_lite(&srcu, id);
 
 	return young;
 }
@@ -391,7 +398,7 @@ int __mmu_notifier_clear_young(struct mm_struct *mm,
 	struct mmu_notifier *subscription;
 	int young = 0, id;
 
-	id = srcu_read_lock(&srcu);
+	id = srcu_read_lock_lite(&srcu);
 	hlist_for_each_entry_rcu(subscription,
 				 &mm->notifier_subscriptions->list, hlist,
 				 srcu_read_lock_held(&srcu)) {
@@ -399,7 +406,7 @@ int __mmu_notifier_clear_young(struct mm_struct *mm,
 			young |= subscription->ops->clear_young(subscription,
 								mm, start, end);
 	}
-	srcu_read_unlock(&srcu, id);
+	srcu_read_unlock_lite(&srcu, id);
 
 	return young;
 }
@@ -410,7 +417,7 @@ int __mmu_notifier_test_young(struct mm_struct *mm,
 	struct mmu_notifier *subscription;
 	int young = 0, id;
 
-	id = srcu_read_lock(&srcu);
+	id = srcu_read_lock_lite(&srcu);
 	hlist_for_each_entry_rcu(subscription,
 				 &mm->notifier_subscriptions->list, hlist,
 				 srcu_read_lock_held(&srcu)) {
@@ -421,7 +428,7 @@ int __mmu_notifier_test_young(struct mm_struct *mm,
 				break;
 		}
 	}
-	srcu_read_unlock(&srcu, id);
+	srcu_read_unlock_lite(&srcu, id);
 
 	return young;
 }
@@ -465,7 +472,7 @@ static int mn_hlist_invalidate_range_start(
 	int ret = 0;
 	int id;
 
-	id = srcu_read_lock(&srcu);
+	id = srcu_read_lock_lite(&srcu);
 	hlist_for_each_entry_rcu(subscription, &subscriptions->list, hlist,
 				 srcu_read_lock_held(&srcu)) {
 		const struct mmu_notifier_ops *ops = subscription->ops;
@@ -513,7 +520,7 @@ static int mn_hlist_invalidate_range_start(
 								range);
 		}
 	}
-	srcu_read_unlock(&srcu, id);
+	srcu_read_unlock_lite(&srcu, id);
 
 	return ret;
 }
@@ -541,7 +548,7 @@ mn_hlist_invalidate_end(struct mmu_notifier_subscriptions *subscriptions,
 	struct mmu_notifier *subscription;
 	int id;
 
-	id = srcu_read_lock(&srcu);
+	id = srcu_read_lock_lite(&srcu);
 	hlist_for_each_entry_rcu(subscription, &subscriptions->list, hlist,
 				 srcu_read_lock_held(&srcu)) {
 		if (subscription->ops->invalidate_range_end) {
@@ -553,7 +560,7 @@ mn_hlist_invalidate_end(struct mmu_notifier_subscriptions *subscriptions,
 				non_block_end();
 		}
 	}
-	srcu_read_unlock(&srcu, id);
+	srcu_read_unlock_lite(&srcu, id);
 }
 
 void __mmu_notifier_invalidate_range_end(struct mmu_notifier_range *range)
@@ -576,7 +583,7 @@ void __mmu_notifier_arch_invalidate_secondary_tlbs(struct mm_struct *mm,
 	struct mmu_notifier *subscription;
 	int id;
 
-	id = srcu_read_lock(&srcu);
+	id = srcu_read_lock_lite(&srcu);
 	hlist_for_each_entry_rcu(subscription,
 				 &mm->notifier_subscriptions->list, hlist,
 				 srcu_read_lock_held(&srcu)) {
@@ -585,7 +592,7 @@ void __mmu_notifier_arch_invalidate_secondary_tlbs(struct mm_struct *mm,
 				subscription, mm,
 				start, end);
 	}
-	srcu_read_unlock(&srcu, id);
+	srcu_read_unlock_lite(&srcu, id);
 }
 
 /*
@@ -806,14 +813,14 @@ void mmu_notifier_unregister(struct mmu_notifier *subscription,
 		 */
 		int id;
 
-		id = srcu_read_lock(&srcu);
+		id = srcu_read_lock_lite(&srcu);
 		/*
 		 * exit_mmap will block in mmu_notifier_release to guarantee
 		 * that ->release is called before freeing the pages.
 		 */
 		if (subscription->ops->release)
 			subscription->ops->release(subscription, mm);
-		srcu_read_unlock(&srcu, id);
+		srcu_read_unlock_lite(&srcu, id);
 
 		spin_lock(&mm->notifier_subscriptions->lock);
 		/*
@@ -511,7 +511,7 @@ static inline unsigned int order_to_pindex(int migratetype, int order)
 	bool __maybe_unused movable;
 
 #ifdef CONFIG_TRANSPARENT_HUGEPAGE
-	if (order > PAGE_ALLOC_COSTLY_ORDER) {
+	if (order > PCP_MAX_LOWORDER) {
 		VM_BUG_ON(order != HPAGE_PMD_ORDER);
 
 		movable = migratetype == MIGRATE_MOVABLE;
@@ -519,7 +519,7 @@ static inline unsigned int order_to_pindex(int migratetype, int order)
 		return NR_LOWORDER_PCP_LISTS + movable;
 	}
 #else
-	VM_BUG_ON(order > PAGE_ALLOC_COSTLY_ORDER);
+	VM_BUG_ON(order > PCP_MAX_LOWORDER);
 #endif
 
 	return (MIGRATE_PCPTYPES * order) + migratetype;
@@ -533,7 +533,7 @@ static inline int pindex_to_order(unsigned int pindex)
 	if (pindex >= NR_LOWORDER_PCP_LISTS)
 		order = HPAGE_PMD_ORDER;
 #else
-	VM_BUG_ON(order > PAGE_ALLOC_COSTLY_ORDER);
+	VM_BUG_ON(order > PCP_MAX_LOWORDER);
 #endif
 
 	return order;
@@ -541,7 +541,7 @@ static inline int pindex_to_order(unsigned int pindex)
 
 static inline bool pcp_allowed_order(unsigned int order)
 {
-	if (order <= PAGE_ALLOC_COSTLY_ORDER)
+	if (order <= PCP_MAX_LOWORDER)
 		return true;
 #ifdef CONFIG_TRANSPARENT_HUGEPAGE
 	if (order == HPAGE_PMD_ORDER)
@@ -2652,7 +2652,7 @@ static void free_unref_page_commit(struct zone *zone, struct per_cpu_pages *pcp,
 	 * freeing without allocation. The remainder after bulk freeing
 	 * stops will be drained from vmstat refresh context.
 	 */
-	if (order && order <= PAGE_ALLOC_COSTLY_ORDER) {
+	if (order && order <= PCP_MAX_LOWORDER) {
 		free_high = (pcp->free_count >= batch &&
 			     (pcp->flags & PCPF_PREV_FREE_HIGH_ORDER) &&
 			     (!(pcp->flags & PCPF_FREE_HIGH_BATCH) ||
@@ -3013,7 +3013,12 @@ static void __init pcpu_fc_free(void *ptr, size_t size)
  * @dyn_size specifies the minimum dynamic area size.
  *
  * If the needed size is smaller than the minimum or specified unit
- * size, the leftover is returned using pcpu_fc_free.
+ * size, the leftover is returned using pcpu_fc_free.  The exception is
+ * when @atom_size is larger than PAGE_SIZE: the leftover is then already
+ * covered by a large linear mapping on the unit's local node, so it is
+ * kept and added to the dynamic area instead.  This lets more dynamic
+ * allocations be served from the first chunk rather than from
+ * vmalloc-backed chunks mapped with base pages.
  *
  * RETURNS:
  * 0 on success, -errno on failure.
@@ -3035,6 +3040,15 @@ int __init pcpu_embed_first_chunk(size_t reserved_size, size_t dyn_size,
 	if (IS_ERR(ai))
 		return PTR_ERR(ai);
 
+	/*
+	 * The tail of each unit lives in the same large linear mapping as
+	 * the rest of the unit.  Hand it to the dynamic area rather than back
+	 * to memblock.
+	 */
+	if (atom_size > PAGE_SIZE)
+		ai->dyn_size = ai->unit_size - ai->static_size -
+			       ai->reserved_size;
+
 	size_sum = ai->static_size + ai->reserved_size + ai->dyn_size;
 	areas_size = PFN_ALIGN(ai->nr_groups * sizeof(void *));
 
@@ -542,6 +542,32 @@ static unsigned long ractl_max_pages(struct readahead_control *ractl,
 	return max_pages;
 }
 
+/*
+ * A read that ends right where the previous one began, with the pages of
+ * that previous read still in the page cache, is most likely part of a
+ * backwards scan.  Read a window ending at the request instead of the
+ * minimal read a random access would get.  No readahead state is kept, as
+ * there is no async marker that a backwards stream would hit.
+ */
+static bool page_cache_reverse_ra(struct readahead_control *ractl,
+		unsigned long req_count, unsigned long max_pages)
+{
+	pgoff_t end = readahead_index(ractl) + req_count;
+	unsigned long nr_to_read;
+	pgoff_t miss;
+
+	rcu_read_lock();
+	miss = page_cache_next_miss(ractl->mapping, end, 1);
+	rcu_read_unlock();
+	if (miss == end)
+		return false;
+
+	nr_to_read = min(max_pages, end);
+	ractl->_index = end - nr_to_read;
+	do_page_cache_ra(ractl, nr_to_read, 0);
+	return true;
+}
+
 void page_cache_sync_ra(struct readahead_control *ractl,
 		unsigned long req_count)
 {
@@ -585,6 +611,11 @@ void page_cache_sync_ra(struct readahead_control *ractl,
 		goto readit;
 	}
 
+	/* Reverse-sequential read, just behind the previous request */
+	if (index < prev_index && prev_index - index <= max_pages &&
+	    page_cache_reverse_ra(ractl, req_count, max_pages))
+		return;
+
 	/*
 	 * Query the page cache and look for the traces(cached history pages)
 	 * that a sequential stream would leave behind.
@@ -1036,6 +1036,37 @@ static bool may_enter_fs(struct folio *folio, gfp_t gfp_mask)
 	return !data_race(folio_swap_flags(folio) & SWP_FS_OPS);
 }
 
+/*
+ * Reclaimed folios can only be freed once the deferred TLB flush for their
+ * unmapping is done. shrink_folio_list() parks full batches of them rather
+ * than flushing for every batch, up to this many pages.
+ */
+#define RECLAIM_DEFERRED_FREE_MAX_PAGES	(SWAP_CLUSTER_MAX * 16)
+
+static void free_reclaimed_folios(struct folio_batch *fbatch,
+				  struct list_head *deferred,
+				  unsigned int *nr_deferred_pages)
+{
+	struct folio *folio, *next;
+
+	mem_cgroup_uncharge_folios(fbatch);
+	try_to_unmap_flush();
+	free_unref_folios(fbatch);
+
+	list_for_each_entry_safe(folio, next, deferred, lru) {
+		list_del(&folio->lru);
+		if (folio_batch_add(fbatch, folio) == 0) {
+			mem_cgroup_uncharge_folios(fbatch);
+			free_unref_folios(fbatch);
+		}
+	}
+	if (folio_batch_count(fbatch)) {
+		mem_cgroup_uncharge_folios(fbatch);
+		free_unref_folios(fbatch);
+	}
+	*nr_deferred_pages = 0;
+}
+
 /*
  * shrink_folio_list() returns the number of reclaimed pages
  */
@@ -1046,6 +1077,8 @@ static unsigned int shrink_folio_list(struct list_head *folio_list,
 	struct folio_batch free_folios;
 	LIST_HEAD(ret_folios);
 	LIST_HEAD(demote_folios);
+	LIST_HEAD(deferred_folios);
+	unsigned int nr_deferred_pages = 0;
 	unsigned int nr_reclaimed = 0;
 	unsigned int pgactivate = 0;
 	bool do_demote_pass;
@@ -1478,9 +1511,23 @@ static unsigned int shrink_folio_list(struct list_head *folio_list,
 
 		folio_unqueue_deferred_split(folio);
 		if (folio_batch_add(&free_folios, folio) == 0) {
-			mem_cgroup_uncharge_folios(&free_folios);
-			try_to_unmap_flush();
-			free_unref_folios(&free_folios);
+			unsigned int i;
+
+			if (!try_to_unmap_flush_pending() ||
+			    nr_deferred_pages >= RECLAIM_DEFERRED_FREE_MAX_PAGES) {
+				free_reclaimed_folios(&free_folios,
+						      &deferred_folios,
+						      &nr_deferred_pages);
+			} else {
+				/* Wait for more unmaps to share the TLB flush */
+				for (i = 0; i < folio_batch_count(&free_folios); i++) {
+					struct folio *f = free_folios.folios[i];
+
+					list_add(&f->lru, &deferred_folios);
+					nr_deferred_pages += folio_nr_pages(f);
+				}
+				folio_batch_reinit(&free_folios);
+			}
 		}
 		continue;
 
@@ -1546,9 +1593,7 @@ static unsigned int shrink_folio_list(struct list_head *folio_list,
 
 	pgactivate = stat->nr_activate[0] + stat->nr_activate[1];
 
-	mem_cgroup_uncharge_folios(&free_folios);
-	try_to_unmap_flush();
-	free_unref_folios(&free_folios);
+	free_reclaimed_folios(&free_folios, &deferred_folios, &nr_deferred_pages);
 
 	list_splice(&ret_folios, folio_list);
 	count_vm_events(PGACTIVATE, pgactivate);
@@ -1966,8 +1966,13 @@ static unsigned long __zs_compact(struct zs_pool *pool,
 		}
 		src_zspage = NULL;
 
+		/*
+		 * Let zs_malloc() and zs_free() of this class, and any reader
+		 * waiting for the pool->migrate_lock, in between zspages.
+		 */
 		if (get_fullness_group(class, dst_zspage) == ZS_INUSE_RATIO_100
-		    || rwlock_is_contended(&pool->migrate_lock)) {
+		    || rwlock_is_contended(&pool->migrate_lock)
+		    || spin_is_contended(&class->lock)) {
 			putback_zspage(class, dst_zspage);
 			dst_zspage = NULL;
 
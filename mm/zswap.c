@@ -141,11 +141,19 @@ bool zswap_never_enabled(void)
 * data structures
 **********************************/
 
+/*
+ * Asynchronous compressors get several requests per CPU, so that the pages of
+ * a large folio can be in flight together. Synchronous ones only get one, as
+ * they complete each request before returning anyway.
+ */
+#define ZSWAP_MAX_BATCH_SIZE 8U
+
 struct crypto_acomp_ctx {
 	struct crypto_acomp *acomp;
-	struct acomp_req *req;
-	struct crypto_wait wait;
-	u8 *buffer;
+	struct acomp_req *reqs[ZSWAP_MAX_BATCH_SIZE];
+	struct crypto_wait waits[ZSWAP_MAX_BATCH_SIZE];
+	u8 *buffers[ZSWAP_MAX_BATCH_SIZE];
+	unsigned int nr_reqs;
 	struct mutex mutex;
 	bool is_sleepable;
 };
@@ -813,54 +821,74 @@ static void zswap_entry_free(struct zswap_entry *entry)
 /*********************************
 * compressed storage functions
 **********************************/
+static void zswap_cpu_comp_free_reqs(struct crypto_acomp_ctx *acomp_ctx)
+{
+	unsigned int i;
+
+	for (i = 0; i < ZSWAP_MAX_BATCH_SIZE; i++) {
+		if (!IS_ERR_OR_NULL(acomp_ctx->reqs[i]))
+			acomp_request_free(acomp_ctx->reqs[i]);
+		acomp_ctx->reqs[i] = NULL;
+		kfree(acomp_ctx->buffers[i]);
+		acomp_ctx->buffers[i] = NULL;
+	}
+}
+
 static int zswap_cpu_comp_prepare(unsigned int cpu, struct hlist_node *node)
 {
 	struct zswap_pool *pool = hlist_entry(node, struct zswap_pool, node);
 	struct crypto_acomp_ctx *acomp_ctx = per_cpu_ptr(pool->acomp_ctx, cpu);
 	struct crypto_acomp *acomp;
 	struct acomp_req *req;
+	unsigned int i;
 	int ret;
 
 	mutex_init(&acomp_ctx->mutex);
 
-	acomp_ctx->buffer = kmalloc_node(PAGE_SIZE * 2, GFP_KERNEL, cpu_to_node(cpu));
-	if (!acomp_ctx->buffer)
-		return -ENOMEM;
-
 	acomp = crypto_alloc_acomp_node(pool->tfm_name, 0, 0, cpu_to_node(cpu));
 	if (IS_ERR(acomp)) {
 		pr_err("could not alloc crypto acomp %s : %ld\n",
 				pool->tfm_name, PTR_ERR(acomp));
-		ret = PTR_ERR(acomp);
-		goto acomp_fail;
+		return PTR_ERR(acomp);
 	}
 	acomp_ctx->acomp = acomp;
 	acomp_ctx->is_sleepable = acomp_is_async(acomp);
+	acomp_ctx->nr_reqs = acomp_ctx->is_sleepable ? ZSWAP_MAX_BATCH_SIZE : 1;
+
+	for (i = 0; i < acomp_ctx->nr_reqs; i++) {
+		acomp_ctx->buffers[i] = kmalloc_node(PAGE_SIZE * 2, GFP_KERNEL,
+						     cpu_to_node(cpu));
+		if (!acomp_ctx->buffers[i]) {
+			ret = -ENOMEM;
+			goto req_fail;
+		}
 
-	req = acomp_request_alloc(acomp_ctx->acomp);
-	if (!req) {
-		pr_err("could not alloc crypto acomp_request %s\n",
-		       pool->tfm_name);
-		ret = -ENOMEM;
-		goto req_fail;
-	}
-	acomp_ctx->req = req;
+		req = acomp_request_alloc(acomp_ctx->acomp);
+		if (!req) {
+			pr_err("could not alloc crypto acomp_request %s\n",
+			       pool->tfm_name);
+			ret = -ENOMEM;
+			goto req_fail;
+		}
+		acomp_ctx->reqs[i] = req;
 
-	crypto_init_wait(&acomp_ctx->wait);
-	/*
-	 * if the backend of acomp is async zip, crypto_req_done() will wakeup
-	 * crypto_wait_req(); if the backend of acomp is scomp, the callback
-	 * won't be called, crypto_wait_req() will return without blocking.
-	 */
-	acomp_request_set_callback(req, CRYPTO_TFM_REQ_MAY_BACKLOG,
-				   crypto_req_done, &acomp_ctx->wait);
+		crypto_init_wait(&acomp_ctx->waits[i]);
+		/*
+		 * if the backend of acomp is async zip, crypto_req_done() will
+		 * wakeup crypto_wait_req(); if the backend of acomp is scomp,
+		 * the callback won't be called, crypto_wait_req() will return
+		 * without blocking.
+		 */
+		acomp_request_set_callback(req, CRYPTO_TFM_REQ_MAY_BACKLOG,
+					   crypto_req_done, &acomp_ctx->waits[i]);
+	}
 
 	return 0;
 
 req_fail:
+	zswap_cpu_comp_free_reqs(acomp_ctx);
 	crypto_free_acomp(acomp_ctx->acomp);
-acomp_fail:
-	kfree(acomp_ctx->buffer);
+	acomp_ctx->acomp = NULL;
 	return ret;
 }
 
@@ -870,77 +898,109 @@ static int zswap_cpu_comp_dead(unsigned int cpu, struct hlist_node *node)
 	struct crypto_acomp_ctx *acomp_ctx = per_cpu_ptr(pool->acomp_ctx, cpu);
 
 	if (!IS_ERR_OR_NULL(acomp_ctx)) {
-		if (!IS_ERR_OR_NULL(acomp_ctx->req))
-			acomp_request_free(acomp_ctx->req);
+		zswap_cpu_comp_free_reqs(acomp_ctx);
 		if (!IS_ERR_OR_NULL(acomp_ctx->acomp))
 			crypto_free_acomp(acomp_ctx->acomp);
-		kfree(acomp_ctx->buffer);
 	}
 
 	return 0;
 }
 
-static bool zswap_compress(struct page *page, struct zswap_entry *entry,
-			   struct zswap_pool *pool)
+/*
+ * Compress @nr pages of @folio starting at @index into @entries. Requests are
+ * submitted before waiting for any of them, so that asynchronous compressors
+ * can work on several pages at once. The batch size is taken from the locked
+ * acomp_ctx; @nr may be larger, in which case the pages are compressed in
+ * several rounds. On failure, no zpool memory is left allocated for any of
+ * the entries.
+ */
+static bool zswap_compress(struct folio *folio, long index, unsigned int nr,
+			   struct zswap_entry **entries, struct zswap_pool *pool)
 {
+	struct scatterlist inputs[ZSWAP_MAX_BATCH_SIZE];
+	struct scatterlist outputs[ZSWAP_MAX_BATCH_SIZE];
+	int errors[ZSWAP_MAX_BATCH_SIZE];
 	struct crypto_acomp_ctx *acomp_ctx;
-	struct scatterlist input, output;
 	int comp_ret = 0, alloc_ret = 0;
-	unsigned int dlen = PAGE_SIZE;
+	struct zpool *zpool = pool->zpool;
+	unsigned int dlen, done, batch, i;
 	unsigned long handle;
-	struct zpool *zpool;
 	char *buf;
 	gfp_t gfp;
-	u8 *dst;
 
+	gfp = __GFP_NORETRY | __GFP_NOWARN | __GFP_KSWAPD_RECLAIM;
+	if (zpool_malloc_support_movable(zpool))
+		gfp |= __GFP_HIGHMEM | __GFP_MOVABLE;
+
+	/*
+	 * We may be migrated to another CPU after this, but the mutex keeps
+	 * the context and its buffers ours until it is unlocked, so only use
+	 * what is read from it under the lock.
+	 */
 	acomp_ctx = raw_cpu_ptr(pool->acomp_ctx);
 
 	mutex_lock(&acomp_ctx->mutex);
 
-	dst = acomp_ctx->buffer;
-	sg_init_table(&input, 1);
-	sg_set_page(&input, page, PAGE_SIZE, 0);
+	for (done = 0; done < nr; done += batch) {
+		batch = min(nr - done, acomp_ctx->nr_reqs);
 
-	/*
-	 * We need PAGE_SIZE * 2 here since there maybe over-compression case,
-	 * and hardware-accelerators may won't check the dst buffer size, so
-	 * giving the dst buffer with enough length to avoid buffer overflow.
-	 */
-	sg_init_one(&output, dst, PAGE_SIZE * 2);
-	acomp_request_set_params(acomp_ctx->req, &input, &output, PAGE_SIZE, dlen);
+		for (i = 0; i < batch; i++) {
+			sg_init_table(&inputs[i], 1);
+			sg_set_page(&inputs[i],
+				    folio_page(folio, index + done + i),
+				    PAGE_SIZE, 0);
 
-	/*
-	 * it maybe looks a little bit silly that we send an asynchronous request,
-	 * then wait for its completion synchronously. This makes the process look
-	 * synchronous in fact.
-	 * Theoretically, acomp supports users send multiple acomp requests in one
-	 * acomp instance, then get those requests done simultaneously. but in this
-	 * case, zswap actually does store and load page by page, there is no
-	 * existing method to send the second page before the first page is done
-	 * in one thread doing zwap.
-	 * but in different threads running on different cpu, we have different
-	 * acomp instance, so multiple threads can do (de)compression in parallel.
-	 */
-	comp_ret = crypto_wait_req(crypto_acomp_compress(acomp_ctx->req), &acomp_ctx->wait);
-	dlen = acomp_ctx->req->dlen;
-	if (comp_ret)
-		goto unlock;
-
-	zpool = pool->zpool;
-	gfp = __GFP_NORETRY | __GFP_NOWARN | __GFP_KSWAPD_RECLAIM;
-	if (zpool_malloc_support_movable(zpool))
-		gfp |= __GFP_HIGHMEM | __GFP_MOVABLE;
-	alloc_ret = zpool_malloc(zpool, dlen, gfp, &handle);
-	if (alloc_ret)
-		goto unlock;
+			/*
+			 * We need PAGE_SIZE * 2 here since there maybe
+			 * over-compression case, and hardware-accelerators may
+			 * won't check the dst buffer size, so giving the dst
+			 * buffer with enough length to avoid buffer overflow.
+			 */
+			sg_init_one(&outputs[i], acomp_ctx->buffers[i],
+				    PAGE_SIZE * 2);
+			acomp_request_set_params(acomp_ctx->reqs[i], &inputs[i],
+						 &outputs[i], PAGE_SIZE,
+						 PAGE_SIZE);
 
-	buf = zpool_map_handle(zpool, handle, ZPOOL_MM_WO);
-	memcpy(buf, dst, dlen);
-	zpool_unmap_handle(zpool, handle);
+			/*
+			 * With a synchronous compressor this completes the
+			 * request right away. An asynchronous one may start
+			 * working on it while the rest of the batch is
+			 * submitted.
+			 */
+			errors[i] = crypto_acomp_compress(acomp_ctx->reqs[i]);
+		}
 
-	entry->handle = handle;
-	entry->length = dlen;
+		for (i = 0; i < batch; i++) {
+			errors[i] = crypto_wait_req(errors[i],
+						    &acomp_ctx->waits[i]);
+			if (errors[i] && !comp_ret)
+				comp_ret = errors[i];
+		}
+		if (comp_ret)
+			goto free_handles;
+
+		for (i = 0; i < batch; i++) {
+			dlen = acomp_ctx->reqs[i]->dlen;
+			alloc_ret = zpool_malloc(zpool, dlen, gfp, &handle);
+			if (alloc_ret) {
+				done += i;
+				goto free_handles;
+			}
+
+			buf = zpool_map_handle(zpool, handle, ZPOOL_MM_WO);
+			memcpy(buf, acomp_ctx->buffers[i], dlen);
+			zpool_unmap_handle(zpool, handle);
+
+			entries[done + i]->handle = handle;
+			entries[done + i]->length = dlen;
+		}
+	}
+	goto unlock;
 
+free_handles:
+	while (done--)
+		zpool_free(zpool, entries[done]->handle);
 unlock:
 	if (comp_ret == -ENOSPC || alloc_ret == -ENOSPC)
 		zswap_reject_compress_poor++;
@@ -975,20 +1035,20 @@ static void zswap_decompress(struct zswap_entry *entry, struct folio *folio)
 	 */
 	if ((acomp_ctx->is_sleepable && !zpool_can_sleep_mapped(zpool)) ||
 	    !virt_addr_valid(src)) {
-		memcpy(acomp_ctx->buffer, src, entry->length);
-		src = acomp_ctx->buffer;
+		memcpy(acomp_ctx->buffers[0], src, entry->length);
+		src = acomp_ctx->buffers[0];
 		zpool_unmap_handle(zpool, entry->handle);
 	}
 
 	sg_init_one(&input, src, entry->length);
 	sg_init_table(&output, 1);
 	sg_set_folio(&output, folio, PAGE_SIZE, 0);
-	acomp_request_set_params(acomp_ctx->req, &input, &output, entry->length, PAGE_SIZE);
-	BUG_ON(crypto_wait_req(crypto_acomp_decompress(acomp_ctx->req), &acomp_ctx->wait));
-	BUG_ON(acomp_ctx->req->dlen != PAGE_SIZE);
+	acomp_request_set_params(acomp_ctx->reqs[0], &input, &output, entry->length, PAGE_SIZE);
+	BUG_ON(crypto_wait_req(crypto_acomp_decompress(acomp_ctx->reqs[0]), &acomp_ctx->waits[0]));
+	BUG_ON(acomp_ctx->reqs[0]->dlen != PAGE_SIZE);
 	mutex_unlock(&acomp_ctx->mutex);
 
-	if (src != acomp_ctx->buffer)
+	if (src != acomp_ctx->buffers[0])
 		zpool_unmap_handle(zpool, entry->handle);
 }
 
@@ -1409,22 +1469,14 @@ static void shrink_worker(struct work_struct *w)
 * main API
 **********************************/
 
+/* Publish a compressed @entry for @page, or free it on failure */
 static ssize_t zswap_store_page(struct page *page,
+				struct zswap_entry *entry,
 				struct obj_cgroup *objcg,
 				struct zswap_pool *pool)
 {
 	swp_entry_t page_swpentry = page_swap_entry(page);
-	struct zswap_entry *entry, *old;
-
-	/* allocate entry */
-	entry = zswap_entry_cache_alloc(GFP_KERNEL, page_to_nid(page));
-	if (!entry) {
-		zswap_reject_kmemcache_fail++;
-		return -EINVAL;
-	}
-
-	if (!zswap_compress(page, entry, pool))
-		goto compress_failed;
+	struct zswap_entry *old;
 
 	old = xa_store(swap_zswap_tree(page_swpentry),
 		       swp_offset(page_swpentry),
@@ -1478,11 +1530,56 @@ static ssize_t zswap_store_page(struct page *page,
 
 store_failed:
 	zpool_free(pool->zpool, entry->handle);
-compress_failed:
 	zswap_entry_cache_free(entry);
 	return -EINVAL;
 }
 
+/*
+ * Compress and store @nr pages of @folio starting at @index, as one batch.
+ * Returns the number of compressed bytes stored, or -EINVAL.
+ */
+static ssize_t zswap_store_pages(struct folio *folio, long index,
+				 unsigned int nr, struct obj_cgroup *objcg,
+				 struct zswap_pool *pool)
+{
+	struct zswap_entry *entries[ZSWAP_MAX_BATCH_SIZE];
+	size_t compressed_bytes = 0;
+	unsigned int i;
+	ssize_t bytes;
+
+	for (i = 0; i < nr; i++) {
+		entries[i] = zswap_entry_cache_alloc(GFP_KERNEL,
+						     folio_nid(folio));
+		if (!entries[i]) {
+			zswap_reject_kmemcache_fail++;
+			goto free_entries;
+		}
+	}
+
+	if (!zswap_compress(folio, index, nr, entries, pool))
+		goto free_entries;
+
+	for (i = 0; i < nr; i++) {
+		bytes = zswap_store_page(folio_page(folio, index + i),
+					 entries[i], objcg, pool);
+		if (bytes < 0) {
+			while (++i < nr) {
+				zpool_free(pool->zpool, entries[i]->handle);
+				zswap_entry_cache_free(entries[i]);
+			}
+			return -EINVAL;
+		}
+		compressed_bytes += bytes;
+	}
+
+	return compressed_bytes;
+
+free_entries:
+	while (i--)
+		zswap_entry_cache_free(entries[i]);
+	return -EINVAL;
+}
+
 bool zswap_store(struct folio *folio)
 {
 	long nr_pages = folio_nr_pages(folio);
@@ -1526,11 +1623,12 @@ bool zswap_store(struct folio *folio)
 		mem_cgroup_put(memcg);
 	}
 
-	for (index = 0; index < nr_pages; ++index) {
-		struct page *page = folio_page(folio, index);
+	for (index = 0; index < nr_pages; index += ZSWAP_MAX_BATCH_SIZE) {
+		unsigned int nr = min_t(long, ZSWAP_MAX_BATCH_SIZE,
+					nr_pages - index);
 		ssize_t bytes;
 
-		bytes = zswap_store_page(page, objcg, pool);
+		bytes = zswap_store_pages(folio, index, nr, objcg, pool);
 		if (bytes < 0)
 			goto put_pool;
 		compressed_bytes += bytes;
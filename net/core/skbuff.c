@@ -1247,16 +1247,37 @@ EXPORT_SYMBOL(sk_skb_reason_drop);
 
 struct skb_free_array {
 	unsigned int skb_count;
+	unsigned int fclone_count;
 	void *skb_array[KFREE_SKB_BULK_SIZE];
+	void *fclone_array[KFREE_SKB_BULK_SIZE];
 };
 
 static void kfree_skb_add_bulk(struct sk_buff *skb,
 			       struct skb_free_array *sa,
 			       enum skb_drop_reason reason)
 {
-	/* if SKB is a clone, don't handle this case */
 	if (unlikely(skb->fclone != SKB_FCLONE_UNAVAILABLE)) {
-		__kfree_skb(skb);
+		struct sk_buff_fclones *fclones;
+
+		/* Only an original whose clone is already gone, as is usual
+		 * for TCP skbs (see kfree_skbmem()), can go in the batch.
+		 */
+		fclones = container_of(skb, struct sk_buff_fclones, skb1);
+		if (skb->fclone != SKB_FCLONE_ORIG ||
+		    refcount_read(&fclones->fclone_ref) != 1) {
+			__kfree_skb(skb);
+			return;
+		}
+
+		skb_release_all(skb, reason);
+		sa->fclone_array[sa->fclone_count++] = fclones;
+
+		if (unlikely(sa->fclone_count == KFREE_SKB_BULK_SIZE)) {
+			kmem_cache_free_bulk(net_hotdata.skbuff_fclone_cache,
+					     KFREE_SKB_BULK_SIZE,
+					     sa->fclone_array);
+			sa->fclone_count = 0;
+		}
 		return;
 	}
 
@@ -1276,6 +1297,7 @@ kfree_skb_list_reason(struct sk_buff *segs, enum skb_drop_reason reason)
 	struct skb_free_array sa;
 
 	sa.skb_count = 0;
+	sa.fclone_count = 0;
 
 	while (segs) {
 		struct sk_buff *next = segs->next;
@@ -1290,6 +1312,9 @@ kfree_skb_list_reason(struct sk_buff *segs, enum skb_drop_reason reason)
 
 	if (sa.skb_count)
 		kmem_cache_free_bulk(net_hotdata.skbuff_cache, sa.skb_count, sa.skb_array);
+	if (sa.fclone_count)
+		kmem_cache_free_bulk(net_hotdata.skbuff_fclone_cache,
+				     sa.fclone_count, sa.fclone_array);
 }
 EXPORT_SYMBOL(kfree_skb_list_reason);
 
@@ -312,13 +312,28 @@ static bool ip_can_use_hint(const struct sk_buff *skb, const struct iphdr *iph,
 	       ip_hdr(hint)->tos == iph->tos;
 }
 
-int tcp_v4_early_demux(struct sk_buff *skb);
-int udp_v4_early_demux(struct sk_buff *skb);
+int tcp_v4_early_demux(struct sk_buff *skb, struct sock *hint);
+int udp_v4_early_demux(struct sk_buff *skb, struct sock *hint);
+
+/*
+ * Sockets found by early demux for the last TCP and UDP skb of a receive list
+ * that had one, tried first for the next one. skbs that the route hint gave a
+ * dst only try these, so a run of skbs from one flow still reaches the
+ * transport layer with skb->sk set. Only valid for the RCU read section the
+ * list is handled in.
+ */
+struct ip_demux_hint {
+	struct sock	*tcp;
+	struct sock	*udp;
+};
+
 static int ip_rcv_finish_core(struct net *net, struct sock *sk,
 			      struct sk_buff *skb, struct net_device *dev,
-			      const struct sk_buff *hint)
+			      const struct sk_buff *hint,
+			      struct ip_demux_hint *demux)
 {
 	const struct iphdr *iph = ip_hdr(skb);
+	bool routed_by_hint = false;
 	int err, drop_reason;
 	struct rtable *rt;
 
@@ -327,25 +342,41 @@ static int ip_rcv_finish_core(struct net *net, struct sock *sk,
 						ip4h_dscp(iph), dev, hint);
 		if (unlikely(drop_reason))
 			goto drop_error;
+		routed_by_hint = true;
 	}
 
+	/*
+	 * An skb routed by the route hint already has its dst, so the full
+	 * early demux lookup is not worth it; the socket hint still is, as it
+	 * saves the transport layer its own lookup for the rest of the flow.
+	 */
 	drop_reason = SKB_DROP_REASON_NOT_SPECIFIED;
 	if (READ_ONCE(net->ipv4.sysctl_ip_early_demux) &&
-	    !skb_dst(skb) &&
+	    (!skb_dst(skb) || routed_by_hint) &&
 	    !skb->sk &&
 	    !ip_is_fragment(iph)) {
 		switch (iph->protocol) {
 		case IPPROTO_TCP:
+			if (routed_by_hint && !demux->tcp)
+				break;
 			if (READ_ONCE(net->ipv4.sysctl_tcp_early_demux)) {
-				tcp_v4_early_demux(skb);
+				tcp_v4_early_demux(skb,
+						   demux ? demux->tcp : NULL);
+				if (demux && skb->sk)
+					demux->tcp = skb->sk;
 
 				/* must reload iph, skb->head might have changed */
 				iph = ip_hdr(skb);
 			}
 			break;
 		case IPPROTO_UDP:
+			if (routed_by_hint && !demux->udp)
+				break;
 			if (READ_ONCE(net->ipv4.sysctl_udp_early_demux)) {
-				err = udp_v4_early_demux(skb);
+				err = udp_v4_early_demux(skb,
+							 demux ? demux->udp : NULL);
+				if (demux && skb->sk)
+					demux->udp = skb->sk;
 				if (unlikely(err))
 					goto drop_error;
 
@@ -442,7 +473,7 @@ static int ip_rcv_finish(struct net *net, struct sock *sk, struct sk_buff *skb)
 	if (!skb)
 		return NET_RX_SUCCESS;
 
-	ret = ip_rcv_finish_core(net, sk, skb, dev, NULL);
+	ret = ip_rcv_finish_core(net, sk, skb, dev, NULL, NULL);
 	if (ret != NET_RX_DROP)
 		ret = dst_input(skb);
 	return ret;
@@ -593,6 +624,7 @@ static void ip_list_rcv_finish(struct net *net, struct sock *sk,
 			       struct list_head *head)
 {
 	struct sk_buff *skb, *next, *hint = NULL;
+	struct ip_demux_hint demux = {};
 	struct dst_entry *curr_dst = NULL;
 	LIST_HEAD(sublist);
 
@@ -607,7 +639,8 @@ static void ip_list_rcv_finish(struct net *net, struct sock *sk,
 		skb = l3mdev_ip_rcv(skb);
 		if (!skb)
 			continue;
-		if (ip_rcv_finish_core(net, sk, skb, dev, hint) == NET_RX_DROP)
+		if (ip_rcv_finish_core(net, sk, skb, dev, hint,
+				       &demux) == NET_RX_DROP)
 			continue;
 
 		dst = skb_dst(skb);
@@ -3346,7 +3346,7 @@ static int tcp_clean_rtx_queue(struct sock *sk, const struct sk_buff *ack_skb,
 	struct tcp_sock *tp = tcp_sk(sk);
 	u32 prior_sacked = tp->sacked_out;
 	u32 reord = tp->snd_nxt; /* lowest acked un-retx un-sacked seq */
-	struct sk_buff *skb, *next;
+	struct sk_buff *skb, *next, *to_free = NULL;
 	bool fully_acked = true;
 	long sack_rtt_us = -1L;
 	long seq_rtt_us = -1L;
@@ -3433,9 +3433,13 @@ static int tcp_clean_rtx_queue(struct sock *sk, const struct sk_buff *ack_skb,
 		if (unlikely(skb == tp->lost_skb_hint))
 			tp->lost_skb_hint = NULL;
 		tcp_highest_sack_replace(sk, skb, next);
-		tcp_rtx_queue_unlink_and_free(skb, sk);
+		tcp_rtx_queue_unlink_and_defer(skb, sk, &to_free);
 	}
 
+	/* A stretch ACK on a fat pipe releases many skbs, free them in bulk */
+	if (to_free)
+		kfree_skb_list_reason(to_free, SKB_CONSUMED);
+
 	if (!skb)
 		tcp_chrono_stop(sk, TCP_CHRONO_BUSY);
 
@@ -1963,12 +1963,39 @@ int tcp_v4_do_rcv(struct sock *sk, struct sk_buff *skb)
 }
 EXPORT_SYMBOL(tcp_v4_do_rcv);
 
-int tcp_v4_early_demux(struct sk_buff *skb)
+/*
+ * Reuse @hint, the socket the previous skb of a receive list was demuxed to,
+ * if it matches this skb as well. Like __inet_lookup_established(), the match
+ * is checked again once a reference is held, as the socket may have been
+ * freed and reused since @hint was looked up.
+ */
+static struct sock *tcp_v4_demux_hint(const struct net *net, struct sock *hint,
+				      const struct iphdr *iph,
+				      const struct tcphdr *th,
+				      int dif, int sdif)
+{
+	INET_ADDR_COOKIE(acookie, iph->saddr, iph->daddr);
+	const __portpair ports = INET_COMBINED_PORTS(th->source,
+						     ntohs(th->dest));
+
+	if (!inet_match(net, hint, acookie, ports, dif, sdif))
+		return NULL;
+	if (unlikely(!refcount_inc_not_zero(&hint->sk_refcnt)))
+		return NULL;
+	if (unlikely(sk_unhashed(hint) ||
+		     !inet_match(net, hint, acookie, ports, dif, sdif))) {
+		sock_gen_put(hint);
+		return NULL;
+	}
+	return hint;
+}
+
+int tcp_v4_early_demux(struct sk_buff *skb, struct sock *hint)
 {
 	struct net *net = dev_net(skb->dev);
 	const struct iphdr *iph;
 	const struct tcphdr *th;
-	struct sock *sk;
+	struct sock *sk = NULL;
 
 	if (skb->pkt_type != PACKET_HOST)
 		return 0;
@@ -1982,14 +2009,20 @@ int tcp_v4_early_demux(struct sk_buff *skb)
 	if (th->doff < sizeof(struct tcphdr) / 4)
 		return 0;
 
-	sk = __inet_lookup_established(net, net->ipv4.tcp_death_row.hashinfo,
-				       iph->saddr, th->source,
-				       iph->daddr, ntohs(th->dest),
-				       skb->skb_iif, inet_sdif(skb));
+	if (hint)
+		sk = tcp_v4_demux_hint(net, hint, iph, th, skb->skb_iif,
+				       inet_sdif(skb));
+	/* Already routed by the list's route hint: only the hint is cheap */
+	if (!sk && !skb_dst(skb))
+		sk = __inet_lookup_established(net,
+					       net->ipv4.tcp_death_row.hashinfo,
+					       iph->saddr, th->source,
+					       iph->daddr, ntohs(th->dest),
+					       skb->skb_iif, inet_sdif(skb));
 	if (sk) {
 		skb->sk = sk;
 		skb->destructor = sock_edemux;
-		if (sk_fullsock(sk)) {
+		if (sk_fullsock(sk) && !skb_dst(skb)) {
 			struct dst_entry *dst = rcu_dereference(sk->sk_rx_dst);
 
 			if (dst)
@@ -1511,6 +1511,19 @@ static int udp_rmem_schedule(struct sock *sk, int size)
 	return 0;
 }
 
+static void udp_rcv_data_ready(struct sock *sk, bool becomes_readable)
+{
+	if (sock_flag(sk, SOCK_DEAD))
+		return;
+
+	if (becomes_readable ||
+	    sk->sk_data_ready != sock_def_readable ||
+	    READ_ONCE(sk->sk_peek_off) >= 0)
+		INDIRECT_CALL_1(sk->sk_data_ready, sock_def_readable, sk);
+	else
+		sk_wake_async_rcu(sk, SOCK_WAKE_WAITD, POLL_IN);
+}
+
 int __udp_enqueue_schedule_skb(struct sock *sk, struct sk_buff *skb)
 {
 	struct sk_buff_head *list = &sk->sk_receive_queue;
@@ -1561,15 +1574,7 @@ int __udp_enqueue_schedule_skb(struct sock *sk, struct sk_buff *skb)
 	__skb_queue_tail(list, skb);
 	spin_unlock(&list->lock);
 
-	if (!sock_flag(sk, SOCK_DEAD)) {
-		if (becomes_readable ||
-		    sk->sk_data_ready != sock_def_readable ||
-		    READ_ONCE(sk->sk_peek_off) >= 0)
-			INDIRECT_CALL_1(sk->sk_data_ready,
-					sock_def_readable, sk);
-		else
-			sk_wake_async_rcu(sk, SOCK_WAKE_WAITD, POLL_IN);
-	}
+	udp_rcv_data_ready(sk, becomes_readable);
 	busylock_release(busy);
 	return 0;
 
@@ -1583,6 +1588,73 @@ int __udp_enqueue_schedule_skb(struct sock *sk, struct sk_buff *skb)
 }
 EXPORT_SYMBOL_GPL(__udp_enqueue_schedule_skb);
 
+/*
+ * Queue a list of skbs for @sk, typically the segments of one GRO packet, the
+ * way __udp_enqueue_schedule_skb() queues a single one, but with the memory
+ * charged, the queue lock taken and the socket woken up once for the whole
+ * list. The receive buffer check is done once as well: the list is admitted
+ * as long as the queue isn't already full, as it would have been had it been
+ * queued unsegmented.
+ *
+ * On error nothing is queued, and @skbs is left for the caller to drop.
+ */
+int __udp_enqueue_schedule_list(struct sock *sk, struct sk_buff_head *skbs)
+{
+	struct sk_buff_head *list = &sk->sk_receive_queue;
+	int rmem, err = -ENOMEM;
+	spinlock_t *busy = NULL;
+	bool becomes_readable;
+	struct sk_buff *skb;
+	int size = 0, rcvbuf;
+
+	if (skb_queue_empty(skbs))
+		return 0;
+
+	rmem = atomic_read(&sk->sk_rmem_alloc);
+	rcvbuf = READ_ONCE(sk->sk_rcvbuf);
+	if (rmem > rcvbuf)
+		goto drop;
+
+	if (rmem > (rcvbuf >> 1))
+		busy = busylock_acquire(sk);
+
+	skb_queue_walk(skbs, skb) {
+		if (busy)
+			skb_condense(skb);
+		size += skb->truesize;
+		udp_set_dev_scratch(skb);
+		sock_skb_set_dropcount(sk, skb);
+	}
+
+	atomic_add(size, &sk->sk_rmem_alloc);
+
+	spin_lock(&list->lock);
+	err = udp_rmem_schedule(sk, size);
+	if (err) {
+		spin_unlock(&list->lock);
+		goto uncharge_drop;
+	}
+
+	sk_forward_alloc_add(sk, -size);
+
+	becomes_readable = skb_queue_empty(list);
+	skb_queue_splice_tail_init(skbs, list);
+	spin_unlock(&list->lock);
+
+	udp_rcv_data_ready(sk, becomes_readable);
+	busylock_release(busy);
+	return 0;
+
+uncharge_drop:
+	atomic_sub(size, &sk->sk_rmem_alloc);
+
+drop:
+	atomic_add(skb_queue_len(skbs), &sk->sk_drops);
+	busylock_release(busy);
+	return err;
+}
+EXPORT_SYMBOL_GPL(__udp_enqueue_schedule_list);
+
 void udp_destruct_common(struct sock *sk)
 {
 	/* reclaim completely the forward allocated memory */
@@ -2049,7 +2121,29 @@ void udp_v4_rehash(struct sock *sk)
 	udp_lib_rehash(sk, new_hash);
 }
 
-static int __udp_queue_rcv_skb(struct sock *sk, struct sk_buff *skb)
+static void udp_queue_rcv_fail(struct sock *sk, struct sk_buff *skb, int rc)
+{
+	int is_udplite = IS_UDPLITE(sk);
+	int drop_reason;
+
+	/* Note that an ENOMEM error is charged twice */
+	if (rc == -ENOMEM) {
+		UDP_INC_STATS(sock_net(sk), UDP_MIB_RCVBUFERRORS,
+				is_udplite);
+		drop_reason = SKB_DROP_REASON_SOCKET_RCVBUFF;
+	} else {
+		UDP_INC_STATS(sock_net(sk), UDP_MIB_MEMERRORS,
+			      is_udplite);
+		drop_reason = SKB_DROP_REASON_PROTO_MEM;
+	}
+	UDP_INC_STATS(sock_net(sk), UDP_MIB_INERRORS, is_udplite);
+	trace_udp_fail_queue_rcv_skb(rc, sk, skb);
+	sk_skb_reason_drop(sk, skb, drop_reason);
+}
+
+/* If @batch is given, @skb is added to it and queued by the caller. */
+static int __udp_queue_rcv_skb(struct sock *sk, struct sk_buff *skb,
+			       struct sk_buff_head *batch)
 {
 	int rc;
 
@@ -2061,24 +2155,14 @@ static int __udp_queue_rcv_skb(struct sock *sk, struct sk_buff *skb)
 		sk_mark_napi_id_once(sk, skb);
 	}
 
+	if (batch) {
+		__skb_queue_tail(batch, skb);
+		return 0;
+	}
+
 	rc = __udp_enqueue_schedule_skb(sk, skb);
 	if (rc < 0) {
-		int is_udplite = IS_UDPLITE(sk);
-		int drop_reason;
-
-		/* Note that an ENOMEM error is charged twice */
-		if (rc == -ENOMEM) {
-			UDP_INC_STATS(sock_net(sk), UDP_MIB_RCVBUFERRORS,
-					is_udplite);
-			drop_reason = SKB_DROP_REASON_SOCKET_RCVBUFF;
-		} else {
-			UDP_INC_STATS(sock_net(sk), UDP_MIB_MEMERRORS,
-				      is_udplite);
-			drop_reason = SKB_DROP_REASON_PROTO_MEM;
-		}
-		UDP_INC_STATS(sock_net(sk), UDP_MIB_INERRORS, is_udplite);
-		trace_udp_fail_queue_rcv_skb(rc, sk, skb);
-		sk_skb_reason_drop(sk, skb, drop_reason);
+		udp_queue_rcv_fail(sk, skb, rc);
 		return -1;
 	}
 
@@ -2093,7 +2177,8 @@ static int __udp_queue_rcv_skb(struct sock *sk, struct sk_buff *skb)
  * Note that in the success and error cases, the skb is assumed to
  * have either been requeued or freed.
  */
-static int udp_queue_rcv_one_skb(struct sock *sk, struct sk_buff *skb)
+static int udp_queue_rcv_one_skb(struct sock *sk, struct sk_buff *skb,
+				 struct sk_buff_head *batch)
 {
 	int drop_reason = SKB_DROP_REASON_NOT_SPECIFIED;
 	struct udp_sock *up = udp_sk(sk);
@@ -2192,7 +2277,7 @@ static int udp_queue_rcv_one_skb(struct sock *sk, struct sk_buff *skb)
 	udp_csum_pull_header(skb);
 
 	ipv4_pktinfo_prepare(sk, skb, true);
-	return __udp_queue_rcv_skb(sk, skb);
+	return __udp_queue_rcv_skb(sk, skb, batch);
 
 csum_error:
 	drop_reason = SKB_DROP_REASON_UDP_CSUM;
@@ -2207,22 +2292,30 @@ static int udp_queue_rcv_one_skb(struct sock *sk, struct sk_buff *skb)
 static int udp_queue_rcv_skb(struct sock *sk, struct sk_buff *skb)
 {
 	struct sk_buff *next, *segs;
+	struct sk_buff_head batch;
 	int ret;
 
 	if (likely(!udp_unexpected_gso(sk, skb)))
-		return udp_queue_rcv_one_skb(sk, skb);
+		return udp_queue_rcv_one_skb(sk, skb, NULL);
 
 	BUILD_BUG_ON(sizeof(struct udp_skb_cb) > SKB_GSO_CB_OFFSET);
 	__skb_push(skb, -skb_mac_offset(skb));
 	segs = udp_rcv_segment(sk, skb, true);
+	__skb_queue_head_init(&batch);
 	skb_list_walk_safe(segs, skb, next) {
 		__skb_pull(skb, skb_transport_offset(skb));
 
 		udp_post_segment_fix_csum(skb);
-		ret = udp_queue_rcv_one_skb(sk, skb);
+		ret = udp_queue_rcv_one_skb(sk, skb, &batch);
 		if (ret > 0)
 			ip_protocol_deliver_rcu(dev_net(skb->dev), skb, ret);
 	}
+
+	ret = __udp_enqueue_schedule_list(sk, &batch);
+	if (ret < 0) {
+		while ((skb = __skb_dequeue(&batch)))
+			udp_queue_rcv_fail(sk, skb, ret);
+	}
 	return 0;
 }
 
@@ -2558,7 +2651,7 @@ static struct sock *__udp4_lib_demux_lookup(struct net *net,
 	return NULL;
 }
 
-int udp_v4_early_demux(struct sk_buff *skb)
+int udp_v4_early_demux(struct sk_buff *skb, struct sock *hint)
 {
 	struct net *net = dev_net(skb->dev);
 	struct in_device *in_dev = NULL;
@@ -2578,6 +2671,10 @@ int udp_v4_early_demux(struct sk_buff *skb)
 	uh = udp_hdr(skb);
 
 	if (skb->pkt_type == PACKET_MULTICAST) {
+		/* routed by the list's route hint, see ip_rcv_finish_core() */
+		if (skb_dst(skb))
+			return 0;
+
 		in_dev = __in_dev_get_rcu(skb->dev);
 
 		if (!in_dev)
@@ -2592,8 +2689,23 @@ int udp_v4_early_demux(struct sk_buff *skb)
 						   uh->source, iph->saddr,
 						   dif, sdif);
 	} else if (skb->pkt_type == PACKET_HOST) {
-		sk = __udp4_lib_demux_lookup(net, uh->dest, iph->daddr,
-					     uh->source, iph->saddr, dif, sdif);
+		INET_ADDR_COOKIE(acookie, iph->saddr, iph->daddr);
+
+		/*
+		 * @hint is the connected socket the previous skb of the same
+		 * receive list was demuxed to. UDP sockets are RCU freed and
+		 * the whole list is handled in one RCU read section, so it is
+		 * safe to look at without a reference.
+		 */
+		if (hint && sk_hashed(hint) &&
+		    inet_match(net, hint, acookie,
+			       INET_COMBINED_PORTS(uh->source, ntohs(uh->dest)),
+			       dif, sdif))
+			sk = hint;
+		else if (!skb_dst(skb))
+			sk = __udp4_lib_demux_lookup(net, uh->dest, iph->daddr,
+						     uh->source, iph->saddr,
+						     dif, sdif);
 	}
 
 	if (!sk)
@@ -2602,6 +2714,8 @@ int udp_v4_early_demux(struct sk_buff *skb)
 	skb->sk = sk;
 	DEBUG_NET_WARN_ON_ONCE(sk_is_refcounted(sk));
 	skb->destructor = sock_pfree;
+	if (skb_dst(skb))
+		return 0;
 	dst = rcu_dereference(sk->sk_rx_dst);
 
 	if (dst)
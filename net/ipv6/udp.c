@@ -643,7 +643,29 @@ int __udp6_lib_err(struct sk_buff *skb, struct inet6_skb_parm *opt,
 	return 0;
 }
 
-static int __udpv6_queue_rcv_skb(struct sock *sk, struct sk_buff *skb)
+static void udpv6_queue_rcv_fail(struct sock *sk, struct sk_buff *skb, int rc)
+{
+	int is_udplite = IS_UDPLITE(sk);
+	enum skb_drop_reason drop_reason;
+
+	/* Note that an ENOMEM error is charged twice */
+	if (rc == -ENOMEM) {
+		UDP6_INC_STATS(sock_net(sk),
+				 UDP_MIB_RCVBUFERRORS, is_udplite);
+		drop_reason = SKB_DROP_REASON_SOCKET_RCVBUFF;
+	} else {
+		UDP6_INC_STATS(sock_net(sk),
+			       UDP_MIB_MEMERRORS, is_udplite);
+		drop_reason = SKB_DROP_REASON_PROTO_MEM;
+	}
+	UDP6_INC_STATS(sock_net(sk), UDP_MIB_INERRORS, is_udplite);
+	trace_udp_fail_queue_rcv_skb(rc, sk, skb);
+	sk_skb_reason_drop(sk, skb, drop_reason);
+}
+
+/* If @batch is given, @skb is added to it and queued by the caller. */
+static int __udpv6_queue_rcv_skb(struct sock *sk, struct sk_buff *skb,
+				 struct sk_buff_head *batch)
 {
 	int rc;
 
@@ -655,24 +677,14 @@ static int __udpv6_queue_rcv_skb(struct sock *sk, struct sk_buff *skb)
 		sk_mark_napi_id_once(sk, skb);
 	}
 
+	if (batch) {
+		__skb_queue_tail(batch, skb);
+		return 0;
+	}
+
 	rc = __udp_enqueue_schedule_skb(sk, skb);
 	if (rc < 0) {
-		int is_udplite = IS_UDPLITE(sk);
-		enum skb_drop_reason drop_reason;
-
-		/* Note that an ENOMEM error is charged twice */
-		if (rc == -ENOMEM) {
-			UDP6_INC_STATS(sock_net(sk),
-					 UDP_MIB_RCVBUFERRORS, is_udplite);
-			drop_reason = SKB_DROP_REASON_SOCKET_RCVBUFF;
-		} else {
-			UDP6_INC_STATS(sock_net(sk),
-				       UDP_MIB_MEMERRORS, is_udplite);
-			drop_reason = SKB_DROP_REASON_PROTO_MEM;
-		}
-		UDP6_INC_STATS(sock_net(sk), UDP_MIB_INERRORS, is_udplite);
-		trace_udp_fail_queue_rcv_skb(rc, sk, skb);
-		sk_skb_reason_drop(sk, skb, drop_reason);
+		udpv6_queue_rcv_fail(sk, skb, rc);
 		return -1;
 	}
 
@@ -687,7 +699,8 @@ static __inline__ int udpv6_err(struct sk_buff *skb,
 			      dev_net(skb->dev)->ipv4.udp_table);
 }
 
-static int udpv6_queue_rcv_one_skb(struct sock *sk, struct sk_buff *skb)
+static int udpv6_queue_rcv_one_skb(struct sock *sk, struct sk_buff *skb,
+				   struct sk_buff_head *batch)
 {
 	enum skb_drop_reason drop_reason = SKB_DROP_REASON_NOT_SPECIFIED;
 	struct udp_sock *up = udp_sk(sk);
@@ -767,7 +780,7 @@ static int udpv6_queue_rcv_one_skb(struct sock *sk, struct sk_buff *skb)
 
 	skb_dst_drop(skb);
 
-	return __udpv6_queue_rcv_skb(sk, skb);
+	return __udpv6_queue_rcv_skb(sk, skb, batch);
 
 csum_error:
 	drop_reason = SKB_DROP_REASON_UDP_CSUM;
@@ -782,22 +795,30 @@ static int udpv6_queue_rcv_one_skb(struct sock *sk, struct sk_buff *skb)
 static int udpv6_queue_rcv_skb(struct sock *sk, struct sk_buff *skb)
 {
 	struct sk_buff *next, *segs;
+	struct sk_buff_head batch;
 	int ret;
 
 	if (likely(!udp_unexpected_gso(sk, skb)))
-		return udpv6_queue_rcv_one_skb(sk, skb);
+		return udpv6_queue_rcv_one_skb(sk, skb, NULL);
 
 	__skb_push(skb, -skb_mac_offset(skb));
 	segs = udp_rcv_segment(sk, skb, false);
+	__skb_queue_head_init(&batch);
 	skb_list_walk_safe(segs, skb, next) {
 		__skb_pull(skb, skb_transport_offset(skb));
 
 		udp_post_segment_fix_csum(skb);
-		ret = udpv6_queue_rcv_one_skb(sk, skb);
+		ret = udpv6_queue_rcv_one_skb(sk, skb, &batch);
 		if (ret > 0)
 			ip6_protocol_deliver_rcu(dev_net(skb->dev), skb, ret,
 						 true);
 	}
+
+	ret = __udp_enqueue_schedule_list(sk, &batch);
+	if (ret < 0) {
+		while ((skb = __skb_dequeue(&batch)))
+			udpv6_queue_rcv_fail(sk, skb, ret);
+	}
 	return 0;
 }
 
@@ -401,7 +401,7 @@ struct svc_pool *svc_pool_for_cpu(struct svc_serv *serv)
 {
 	struct svc_pool_map *m = &svc_pool_map;
 	int cpu = raw_smp_processor_id();
-	unsigned int pidx = 0;
+	unsigned int pidx = 0, i;
 
 	if (serv->sv_nrpools <= 1)
 		return serv->sv_pools;
@@ -415,7 +415,21 @@ struct svc_pool *svc_pool_for_cpu(struct svc_serv *serv)
 		break;
 	}
 
-	return &serv->sv_pools[pidx % serv->sv_nrpools];
+	pidx %= serv->sv_nrpools;
+
+	/*
+	 * Threads are started per pool, so with fewer threads than pools some
+	 * pools have none. Nothing would ever dequeue a transport queued on
+	 * such a pool, so move on to the next pool that has threads.
+	 */
+	for (i = 0; i < serv->sv_nrpools; i++) {
+		struct svc_pool *pool = &serv->sv_pools[pidx];
+
+		if (READ_ONCE(pool->sp_nrthreads))
+			return pool;
+		pidx = (pidx + 1) % serv->sv_nrpools;
+	}
+	return &serv->sv_pools[pidx];
 }
 
 static int svc_rpcb_setup(struct svc_serv *serv, struct net *net)
@@ -5,6 +5,7 @@
  *
  * Sorted alphabetically.
  */
+#include <asm/desc_defs.h>
 // Instruction attribute analysis helper function
 #include <asm/inat.h>
 // In kernel disassembler
@@ -13,12 +14,14 @@
 #include <asm/pgtable_types.h>
 #include <asm/syscall.h>
 #include <asm-generic/sections.h>
+#include <crypto/hash.h>
 #include <kunit/test.h>
 #include <linux/binfmts.h>
 #include <linux/blk-mq.h>
 #include <linux/blk_types.h>
 #include <linux/blkdev.h>
 #include <linux/cred.h>
+#include <linux/debugfs.h>
 #include <linux/dirent.h>
 #include <linux/errname.h>
 #include <linux/ethtool.h>
@@ -39,6 +42,7 @@
 #include <linux/pid_namespace.h>
 #include <linux/poll.h>
 #include <linux/preempt.h>
+#include <linux/ptdump.h>
 #include <linux/refcount.h>
 #include <linux/sched.h>
 #include <linux/security.h>
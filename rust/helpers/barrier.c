@@ -0,0 +1,17 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <asm/barrier.h>
+
+/*
+ * Acquire/release accessors for the producer and consumer positions of
+ * rings shared with userspace, in the same way as kernel/bpf/ringbuf.c.
+ */
+unsigned long rust_helper_smp_load_acquire_ulong(const unsigned long *p)
+{
+	return smp_load_acquire(p);
+}
+
+void rust_helper_smp_store_release_ulong(unsigned long *p, unsigned long val)
+{
+	smp_store_release(p, val);
+}
@@ -0,0 +1,17 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <linux/bitmap.h>
+#include <linux/find.h>
+
+void rust_helper_bitmap_xor(unsigned long *dst, const unsigned long *src1,
+			    const unsigned long *src2, unsigned int nbits)
+{
+	bitmap_xor(dst, src1, src2, nbits);
+}
+
+unsigned long rust_helper_find_next_bit(const unsigned long *addr,
+					unsigned long size,
+					unsigned long offset)
+{
+	return find_next_bit(addr, size, offset);
+}
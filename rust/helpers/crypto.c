@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <crypto/hash.h>
+#include <linux/mm.h>
+#include <linux/sched.h>
+
+#if IS_BUILTIN(CONFIG_CRYPTO_HASH)
+unsigned int rust_helper_crypto_shash_digestsize(struct crypto_shash *tfm)
+{
+	return crypto_shash_digestsize(tfm);
+}
+
+/*
+ * Hash the @npages pages starting at @start one page at a time, storing one
+ * digest of crypto_shash_digestsize(@tfm) bytes per page in @digests, so a
+ * later mismatch points at the page that changed.
+ *
+ * The accelerated shash drivers (SHA-NI, AVX2) manage the FPU section
+ * themselves; callers that want to use several CPUs split the range and run
+ * one call per chunk from a workqueue, each with its own @tfm.
+ */
+int rust_helper_crypto_shash_digest_pages(struct crypto_shash *tfm,
+					  const void *start,
+					  unsigned long npages, u8 *digests)
+{
+	SHASH_DESC_ON_STACK(desc, tfm);
+	unsigned int ds = crypto_shash_digestsize(tfm);
+	unsigned long i;
+	int err = 0;
+
+	desc->tfm = tfm;
+	for (i = 0; i < npages; i++) {
+		err = crypto_shash_digest(desc, start + i * PAGE_SIZE,
+					  PAGE_SIZE, digests + i * ds);
+		if (err)
+			break;
+		cond_resched();
+	}
+
+	shash_desc_zero(desc);
+	return err;
+}
+#endif
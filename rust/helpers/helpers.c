@@ -7,24 +7,34 @@
  * Sorted alphabetically.
  */
 
+#include "barrier.c"
+#include "bitmap.c"
 #include "blk.c"
 #include "bug.c"
 #include "build_assert.c"
 #include "build_bug.c"
 #include "cred.c"
+#include "crypto.c"
 #include "err.c"
 #include "fs.c"
+#include "insn.c"
 #include "jump_label.c"
 #include "kunit.c"
+#include "msr.c"
 #include "mutex.c"
 #include "page.c"
+#include "percpu.c"
 #include "pid_namespace.c"
+#include "poll.c"
+#include "ptdump.c"
 #include "rbtree.c"
 #include "refcount.c"
+#include "sched.c"
 #include "security.c"
 #include "signal.c"
 #include "slab.c"
 #include "spinlock.c"
+#include "syscall.c"
 #include "task.c"
 #include "uaccess.c"
 #include "vmalloc.c"
@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <asm/insn.h>
+#include <asm/text-patching.h>
+
+int rust_helper_insn_decode_kernel(struct insn *insn, const void *kaddr)
+{
+	return insn_decode_kernel(insn, kaddr);
+}
+
+/*
+ * Decode the instruction at @kaddr and return its length, or a negative
+ * errno. For relative calls and jumps the branch target is stored in
+ * @target, otherwise it is set to 0.
+ *
+ * Length and target are all a code-pointer scan needs from an instruction,
+ * so callers can cache them per address (together with a hash of the
+ * instruction bytes) rather than keeping the whole struct insn around and
+ * decoding the same text again on every pass.
+ */
+int rust_helper_insn_decode_branch(const void *kaddr, unsigned long *target)
+{
+	struct insn insn;
+	u8 op;
+	int ret;
+
+	ret = insn_decode_kernel(&insn, kaddr);
+	if (ret < 0)
+		return ret;
+
+	*target = 0;
+	op = insn.opcode.bytes[0];
+	/* call, jmp, jcc rel8, loop/loope/loopne/jcxz rel8 and jcc rel32 */
+	if (op == CALL_INSN_OPCODE || op == JMP32_INSN_OPCODE ||
+	    op == JMP8_INSN_OPCODE || (op >= 0x70 && op <= 0x7f) ||
+	    (op >= 0xe0 && op <= 0xe3) ||
+	    (op == 0x0f && insn.opcode.bytes[1] >= 0x80 &&
+	     insn.opcode.bytes[1] <= 0x8f))
+		*target = (unsigned long)kaddr + insn.length +
+			  insn.immediate.value;
+
+	return insn.length;
+}
@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <linux/cpumask.h>
+#include <linux/smp.h>
+#include <asm/msr.h>
+
+struct msr_set_info {
+	const u32 *msrs;
+	unsigned int nr;
+	u64 *vals;
+};
+
+static void __rdmsr_set_on_cpu(void *data)
+{
+	struct msr_set_info *info = data;
+	u64 *vals = info->vals + smp_processor_id() * info->nr;
+	unsigned int i;
+
+	for (i = 0; i < info->nr; i++) {
+		if (rdmsrl_safe(info->msrs[i], &vals[i]))
+			vals[i] = 0;
+	}
+}
+
+/*
+ * Read the @nr MSRs listed in @msrs on every online CPU with a single
+ * broadcast. @vals is indexed by cpu * @nr + i and must hold nr_cpu_ids * @nr
+ * entries; entries of offline CPUs are left untouched and MSRs that fault
+ * read as 0. Each CPU's row can then be compared in bulk against the
+ * expected values, e.g. with rust_helper_table_first_diff().
+ */
+void rust_helper_rdmsr_set_on_each_cpu(const u32 *msrs, unsigned int nr,
+				       u64 *vals)
+{
+	struct msr_set_info info = {
+		.msrs	= msrs,
+		.nr	= nr,
+		.vals	= vals,
+	};
+
+	on_each_cpu(__rdmsr_set_on_cpu, &info, 1);
+}
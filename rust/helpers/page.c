@@ -7,7 +7,9 @@
 #include "linux/types.h"
 #include <linux/gfp.h>
 #include <linux/highmem.h>
+#include <linux/jhash.h>
 #include <linux/smp.h>
+#include <asm/tlbflush.h>
 #include <linux/pgtable.h>
 #include <linux/page-flags.h>
 
@@ -34,7 +36,18 @@ void rust_helper___native_flush_tlb_single(void *addr)
 
 void rust_helper_flush_tlb_each_cpu(unsigned long addr)
 {
-	on_each_cpu(rust_helper___native_flush_tlb_single, (void *)addr, 1);
+	flush_tlb_kernel_range(addr, addr + PAGE_SIZE);
+}
+
+/*
+ * Flush [start, end) on every CPU with a single IPI round. Callers patching
+ * several entries should accumulate the covered range and flush it once
+ * instead of calling rust_helper_flush_tlb_each_cpu() per address: above
+ * tlb_single_page_flush_ceiling pages the arch code switches to a full flush.
+ */
+void rust_helper_flush_tlb_kernel_range(unsigned long start, unsigned long end)
+{
+	flush_tlb_kernel_range(start, end);
 }
 
 unsigned long rust_helper_pmd_pfn(pmd_t pmd)
@@ -77,6 +90,11 @@ pte_t rust_helper_pfn_pte(unsigned long pfn, pgprot_t pgprot)
 	return pfn_pte(pfn, pgprot);
 }
 
+struct page *rust_helper_folio_page(struct folio *folio, unsigned long n)
+{
+	return folio_page(folio, n);
+}
+
 int rust_helper_page_high_mem(const struct page *page)
 {
 	return PageHighMem(page);
@@ -127,7 +145,90 @@ int rust_helper_p4d_present(p4d_t p4d)
 	return p4d_present(p4d);
 }
 
+int rust_helper_pmd_leaf(pmd_t pmd)
+{
+	return pmd_leaf(pmd);
+}
+
+int rust_helper_pud_leaf(pud_t pud)
+{
+	return pud_leaf(pud);
+}
+
+unsigned long rust_helper_pud_pfn(pud_t pud)
+{
+	return pud_pfn(pud);
+}
+
+pgprot_t rust_helper_pud_pgprot(pud_t pud)
+{
+	return pud_pgprot(pud);
+}
+
 int rust_helper_pgd_present(pgd_t pgd)
 {
 	return pgd_present(pgd);
-}
\ No newline at end of file
+}
+
+/*
+ * Hardware sets the accessed and dirty bits behind our back, leave them out
+ * of the fingerprints so that they only change when a mapping does.
+ */
+static u32 pt_fingerprint_mix(u64 pfn, pgprotval_t prot, u32 initval)
+{
+	u64 flags = prot;
+	u32 words[4] = { lower_32_bits(pfn), upper_32_bits(pfn),
+			 lower_32_bits(flags), upper_32_bits(flags) };
+
+	return jhash2(words, ARRAY_SIZE(words), initval);
+}
+
+static u32 pt_fingerprint_pte(pte_t pte, u32 initval)
+{
+	if (pte_present(pte))
+		pte = pte_mkold(pte_mkclean(pte));
+	return pt_fingerprint_mix(pte_pfn(pte), pgprot_val(pte_pgprot(pte)),
+				  initval);
+}
+
+/* Fingerprint of a single PMD entry, from its pfn and protection bits. */
+u32 rust_helper_pmd_fingerprint(pmd_t pmd)
+{
+#ifdef CONFIG_TRANSPARENT_HUGEPAGE
+	if (pmd_present(pmd))
+		pmd = pmd_mkold(pmd_mkclean(pmd));
+#endif
+	return pt_fingerprint_mix(pmd_pfn(pmd), pgprot_val(pmd_pgprot(pmd)), 0);
+}
+
+/*
+ * Fingerprint of everything mapped through @pmdp: the PMD entry itself and,
+ * when it points to a page table, every PTE below it. An incremental scanner
+ * stores one of these per PMD and only does its own per-PTE work when the
+ * value changed since the last pass.
+ *
+ * The fingerprint itself is not incremental: every call rereads and hashes
+ * all PTRS_PER_PTE entries of the table. That is one sequential pass over a
+ * single page, done in C, against a scanner that would otherwise inspect and
+ * compare each entry across the Rust boundary; nothing in the page tables
+ * records which entries changed, so there is nothing cheaper to go on.
+ */
+u32 rust_helper_pmd_range_fingerprint(pmd_t *pmdp)
+{
+	pmd_t pmd = pmdp_get(pmdp);
+	u32 fp = rust_helper_pmd_fingerprint(pmd);
+	pte_t *ptep;
+	int i;
+
+	if (!pmd_present(pmd) || pmd_leaf(pmd))
+		return fp;
+
+	ptep = pte_offset_kernel(pmdp, 0);
+	for (i = 0; i < PTRS_PER_PTE; i++) {
+		pte_t pte = ptep_get(ptep + i);
+
+		fp = pt_fingerprint_pte(pte, fp);
+	}
+
+	return fp;
+}
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <linux/debugfs.h>
+#include <linux/percpu.h>
+
+/*
+ * Per-CPU u64 counter arrays: updates only touch the local CPU's copy, the
+ * per-CPU values are summed when read.
+ */
+u64 __percpu *rust_helper_alloc_percpu_u64(size_t nr)
+{
+	return __alloc_percpu(nr * sizeof(u64), __alignof__(u64));
+}
+
+void rust_helper_this_cpu_add_u64(u64 __percpu *p, u64 val)
+{
+	this_cpu_add(*p, val);
+}
+
+u64 rust_helper_percpu_u64_sum(u64 __percpu *p)
+{
+	u64 sum = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		sum += *per_cpu_ptr(p, cpu);
+
+	return sum;
+}
+
+static int percpu_u64_debugfs_get(void *data, u64 *val)
+{
+	*val = rust_helper_percpu_u64_sum((u64 __percpu __force *)data);
+	return 0;
+}
+DEFINE_DEBUGFS_ATTRIBUTE(percpu_u64_debugfs_fops, percpu_u64_debugfs_get,
+			 NULL, "%llu\n");
+
+/* Create a debugfs file showing the sum of a per-CPU counter. */
+struct dentry *rust_helper_debugfs_create_percpu_u64(const char *name,
+						     umode_t mode,
+						     struct dentry *parent,
+						     u64 __percpu *value)
+{
+	return debugfs_create_file_unsafe(name, mode, parent,
+					  (void __force *)value,
+					  &percpu_u64_debugfs_fops);
+}
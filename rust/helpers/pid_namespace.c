@@ -1,7 +1,10 @@
 // SPDX-License-Identifier: GPL-2.0
 
 #include <linux/pid_namespace.h>
+#include <linux/bitmap.h>
 #include <linux/cleanup.h>
+#include <linux/idr.h>
+#include <linux/sched/signal.h>
 
 struct pid_namespace *rust_helper_get_pid_ns(struct pid_namespace *ns)
 {
@@ -24,3 +27,43 @@ struct pid_namespace *rust_helper_task_get_pid_ns(struct task_struct *task)
 		get_pid_ns(pid_ns);
 	return pid_ns;
 }
+
+/*
+ * Build PID-indexed bitmaps of the thread groups visible in @ns, once from
+ * the namespace's PID IDR and once from the task list. Tasks hidden from
+ * one of the two show up as differing bits, see rust_helper_bitmap_xor().
+ * Only tgids below @nbits are recorded.
+ */
+void rust_helper_pid_ns_tgid_bitmap(struct pid_namespace *ns,
+				    unsigned long *bitmap, unsigned int nbits)
+{
+	struct pid *pid;
+	int nr;
+
+	bitmap_zero(bitmap, nbits);
+
+	guard(rcu)();
+	idr_for_each_entry(&ns->idr, pid, nr) {
+		if (nr >= nbits)
+			break;
+		if (pid_task(pid, PIDTYPE_TGID))
+			__set_bit(nr, bitmap);
+	}
+}
+
+void rust_helper_task_list_tgid_bitmap(struct pid_namespace *ns,
+				       unsigned long *bitmap,
+				       unsigned int nbits)
+{
+	struct task_struct *p;
+	pid_t nr;
+
+	bitmap_zero(bitmap, nbits);
+
+	guard(rcu)();
+	for_each_process(p) {
+		nr = task_tgid_nr_ns(p, ns);
+		if (nr > 0 && nr < nbits)
+			__set_bit(nr, bitmap);
+	}
+}
@@ -1,7 +1,45 @@
+#include <linux/cleanup.h>
+#include <linux/pid.h>
+#include <linux/rcupdate.h>
 #include <linux/sched/signal.h>
+#include <linux/sched/task.h>
 #include <linux/sched.h>
 
 struct task_struct *rust_helper_next_task(const struct task_struct *p)
 {
 	return next_task(p);
-}
\ No newline at end of file
+}
+
+/*
+ * Find the thread group leader with the lowest tgid in [*nr, end) as seen
+ * from @ns, take a reference on it and move *nr past it. RCU is only held
+ * for the lookup itself, so a task sweep split into PID ranges can run each
+ * range on its own worker without one long read-side critical section.
+ */
+struct task_struct *rust_helper_next_tgid_in_range(struct pid_namespace *ns,
+						   pid_t *nr, pid_t end)
+{
+	struct task_struct *task;
+	struct pid *pid;
+
+	guard(rcu)();
+	while (*nr < end) {
+		pid = find_ge_pid(*nr, ns);
+		if (!pid)
+			break;
+
+		*nr = pid_nr_ns(pid, ns);
+		if (*nr >= end)
+			break;
+		*nr += 1;
+
+		task = pid_task(pid, PIDTYPE_TGID);
+		if (task) {
+			get_task_struct(task);
+			return task;
+		}
+	}
+
+	*nr = end;
+	return NULL;
+}
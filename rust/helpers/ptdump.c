@@ -0,0 +1,16 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <linux/mm.h>
+#include <linux/ptdump.h>
+
+#ifdef CONFIG_PTDUMP_CORE
+/*
+ * Walk the kernel page tables over st->range. Leaf PUD/PMD entries are
+ * reported once through st->note_page() without descending further, so a
+ * caller can merge contiguous ranges instead of visiting every 4K entry.
+ */
+void rust_helper_ptdump_walk_kernel(struct ptdump_state *st)
+{
+	ptdump_walk_pgd(st, &init_mm, NULL);
+}
+#endif
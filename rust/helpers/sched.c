@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <linux/sched.h>
+#include <linux/sched/clock.h>
+#include <linux/sched/signal.h>
+
+int rust_helper_need_resched(void)
+{
+	return need_resched();
+}
+
+int rust_helper_cond_resched(void)
+{
+	return cond_resched();
+}
+
+u64 rust_helper_local_clock(void)
+{
+	return local_clock();
+}
+
+/*
+ * For work split into resumable chunks: tell whether the chunk loop that
+ * started at @start_ns (local_clock()) should stop and requeue itself,
+ * either because its CPU budget is spent or because something else wants
+ * the CPU. Checked between chunks, this keeps a long scan from taking a
+ * whole time slice away from latency-sensitive tasks.
+ */
+bool rust_helper_chunk_budget_exceeded(u64 start_ns, u64 budget_ns)
+{
+	return need_resched() || signal_pending(current) ||
+	       local_clock() - start_ns >= budget_ns;
+}
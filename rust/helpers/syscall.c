@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <linux/string.h>
+#include <asm/desc.h>
+#include <asm/syscall.h>
+#include <asm/unistd.h>
+
+size_t rust_helper_nr_syscalls(void)
+{
+	return NR_syscalls;
+}
+
+const sys_call_ptr_t *rust_helper_sys_call_table(void)
+{
+	return sys_call_table;
+}
+
+/* Address of the IDT currently loaded on this CPU. */
+const gate_desc *rust_helper_idt_base(void)
+{
+	struct desc_ptr dtr;
+
+	store_idt(&dtr);
+	return (const gate_desc *)dtr.address;
+}
+
+unsigned long rust_helper_gate_offset(const gate_desc *g)
+{
+	return gate_offset(g);
+}
+
+/*
+ * Compare the entries [from, nr) of a live table against a snapshot of it,
+ * each entry being @entsize bytes. Returns the index of the first entry
+ * that differs, or @nr if they all match.
+ *
+ * The common case is a single memcmp() over the whole range; only when it
+ * fails is the range bisected to find the offending entry, so that the
+ * caller only has to symbolize the entries that actually changed.
+ */
+size_t rust_helper_table_first_diff(const void *live, const void *snap,
+				    size_t entsize, size_t from, size_t nr)
+{
+	const u8 *l = live, *s = snap;
+	size_t lo = from, hi = nr;
+
+	if (from >= nr ||
+	    !memcmp(l + from * entsize, s + from * entsize,
+		    (nr - from) * entsize))
+		return nr;
+
+	while (hi - lo > 1) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (memcmp(l + lo * entsize, s + lo * entsize,
+			   (mid - lo) * entsize))
+			hi = mid;
+		else
+			lo = mid;
+	}
+
+	return lo;
+}
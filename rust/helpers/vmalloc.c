@@ -7,3 +7,19 @@ rust_helper_vrealloc(const void *p, size_t size, gfp_t flags)
 {
 	return vrealloc(p, size, flags);
 }
+
+/* Zeroed and suitable for remap_vmalloc_range() into userspace. */
+void *rust_helper_vmalloc_user(unsigned long size)
+{
+	return vmalloc_user(size);
+}
+
+/*
+ * Map @count pages read-only and virtually contiguous, so a range of pages
+ * can be inspected in one pass instead of a kmap_local_page() and
+ * kunmap_local() per page. Undo with vunmap().
+ */
+void *rust_helper_vmap_pages_ro(struct page **pages, unsigned int count)
+{
+	return vmap(pages, count, VM_MAP, PAGE_KERNEL_RO);
+}
@@ -6,3 +6,8 @@ void rust_helper_init_wait(struct wait_queue_entry *wq_entry)
 {
 	init_wait(wq_entry);
 }
+
+void rust_helper_wake_up_interruptible(struct wait_queue_head *wq_head)
+{
+	wake_up_interruptible(wq_head);
+}
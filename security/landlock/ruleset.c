@@ -98,6 +98,31 @@ static bool is_object_pointer(const enum landlock_key_type key_type)
 	}
 }
 
+/*
+ * Transposes the layer stack of @rule into per-access layer masks, so that
+ * landlock_unmask_layers() does not have to walk every layer for each
+ * requested access.  Layers with a zero level belong to a ruleset that is not
+ * yet a domain and are never checked against.
+ */
+static void compute_rule_grants(struct landlock_rule *const rule)
+{
+	size_t layer_level;
+
+	memset(rule->grants, 0, sizeof(rule->grants));
+	for (layer_level = 0; layer_level < rule->num_layers; layer_level++) {
+		const struct landlock_layer *const layer =
+			&rule->layers[layer_level];
+		const unsigned long access = layer->access;
+		unsigned long access_bit;
+
+		if (!layer->level)
+			continue;
+
+		for_each_set_bit(access_bit, &access, ARRAY_SIZE(rule->grants))
+			rule->grants[access_bit] |= BIT_ULL(layer->level - 1);
+	}
+}
+
 static struct landlock_rule *
 create_rule(const struct landlock_id id,
 	    const struct landlock_layer (*const layers)[], const u32 num_layers,
@@ -134,6 +159,7 @@ create_rule(const struct landlock_id id,
 	if (new_layer)
 		/* Adds a copy of @new_layer on the layer stack. */
 		new_rule->layers[new_rule->num_layers - 1] = *new_layer;
+	compute_rule_grants(new_rule);
 	return new_rule;
 }
 
@@ -624,11 +650,15 @@ bool landlock_unmask_layers(const struct landlock_rule *const rule,
 			    layer_mask_t (*const layer_masks)[],
 			    const size_t masks_array_size)
 {
-	size_t layer_level;
+	const unsigned long access_req = access_request;
+	unsigned long access_bit;
+	bool is_empty = true;
 
 	if (!access_request || !layer_masks)
 		return true;
-	if (!rule)
+	if (!rule || !rule->num_layers)
+		return false;
+	if (WARN_ON_ONCE(masks_array_size > ARRAY_SIZE(rule->grants)))
 		return false;
 
 	/*
@@ -640,29 +670,15 @@ bool landlock_unmask_layers(const struct landlock_rule *const rule,
 	 * policy layer, the full set of requested accesses may not be granted
 	 * by only one rule, but by the union (binary OR) of multiple rules.
 	 * E.g. /a/b <execute> + /a <read> => /a/b <execute + read>
+	 *
+	 * Records in @layer_masks which layers grant access to each requested
+	 * access, using the per-access layer masks precomputed for @rule.
 	 */
-	for (layer_level = 0; layer_level < rule->num_layers; layer_level++) {
-		const struct landlock_layer *const layer =
-			&rule->layers[layer_level];
-		const layer_mask_t layer_bit = BIT_ULL(layer->level - 1);
-		const unsigned long access_req = access_request;
-		unsigned long access_bit;
-		bool is_empty;
-
-		/*
-		 * Records in @layer_masks which layer grants access to each
-		 * requested access.
-		 */
-		is_empty = true;
-		for_each_set_bit(access_bit, &access_req, masks_array_size) {
-			if (layer->access & BIT_ULL(access_bit))
-				(*layer_masks)[access_bit] &= ~layer_bit;
-			is_empty = is_empty && !(*layer_masks)[access_bit];
-		}
-		if (is_empty)
-			return true;
+	for_each_set_bit(access_bit, &access_req, masks_array_size) {
+		(*layer_masks)[access_bit] &= ~rule->grants[access_bit];
+		is_empty = is_empty && !(*layer_masks)[access_bit];
 	}
-	return false;
+	return is_empty;
 }
 
 typedef access_mask_t
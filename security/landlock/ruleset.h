@@ -60,6 +60,8 @@ static_assert(sizeof(typeof_member(union access_masks_all, masks)) ==
 typedef u16 layer_mask_t;
 /* Makes sure all layers can be checked. */
 static_assert(BITS_PER_TYPE(layer_mask_t) >= LANDLOCK_MAX_NUM_LAYERS);
+/* Makes sure landlock_rule.grants can hold all network access rights. */
+static_assert(LANDLOCK_NUM_ACCESS_FS >= LANDLOCK_NUM_ACCESS_NET);
 
 /**
  * struct landlock_layer - Access rights for a given layer
@@ -142,6 +144,14 @@ struct landlock_rule {
 	 * @num_layers: Number of entries in @layers.
 	 */
 	u32 num_layers;
+	/**
+	 * @grants: For each access right, the set of layers (as a layer mask)
+	 * for which this rule grants it.  This is the transpose of @layers,
+	 * computed once when the rule is created, and is only meaningful for
+	 * rules tied to a domain.  Only %LANDLOCK_NUM_ACCESS_NET entries are
+	 * used by network rules.
+	 */
+	layer_mask_t grants[LANDLOCK_NUM_ACCESS_FS];
 	/**
 	 * @layers: Stack of layers, from the latest to the newest, implemented
 	 * as a flexible array member (FAM).
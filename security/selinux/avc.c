@@ -37,6 +37,7 @@
 #define AVC_CACHE_SLOTS			512
 #define AVC_DEF_CACHE_THRESHOLD		512
 #define AVC_CACHE_RECLAIM		16
+#define AVC_PCPU_SLOTS			64
 
 #ifdef CONFIG_SECURITY_SELINUX_AVC_STATS
 #define avc_cache_stats_incr(field)	this_cpu_inc(avc_cache_stats.field)
@@ -76,6 +77,24 @@ struct avc_cache {
 	u32			latest_notif;	/* latest revocation notification */
 };
 
+/*
+ * Small direct-mapped per-CPU copy of recent decisions, consulted before the
+ * shared hash table.  Entries hold the decision by value and are only valid
+ * while their generation matches avc_pcpu_gen, which is bumped whenever a
+ * node is replaced or the cache is flushed.
+ */
+struct avc_pcpu_entry {
+	u32			gen;
+	u32			ssid;
+	u32			tsid;
+	u16			tclass;
+	struct av_decision	avd;
+};
+
+struct avc_pcpu_cache {
+	struct avc_pcpu_entry	slots[AVC_PCPU_SLOTS];
+};
+
 struct avc_callback_node {
 	int (*callback) (u32 event);
 	u32 events;
@@ -93,6 +112,9 @@ struct selinux_avc {
 
 static struct selinux_avc selinux_avc;
 
+static DEFINE_PER_CPU(struct avc_pcpu_cache, avc_pcpu_cache);
+static atomic_t avc_pcpu_gen = ATOMIC_INIT(1);
+
 void selinux_avc_init(void)
 {
 	int i;
@@ -127,6 +149,62 @@ static inline u32 avc_hash(u32 ssid, u32 tsid, u16 tclass)
 	return (ssid ^ (tsid<<2) ^ (tclass<<4)) & (AVC_CACHE_SLOTS - 1);
 }
 
+static inline u32 avc_pcpu_hash(u32 ssid, u32 tsid, u16 tclass)
+{
+	return (ssid ^ (tsid<<2) ^ (tclass<<4)) & (AVC_PCPU_SLOTS - 1);
+}
+
+/*
+ * Callers must make the table update visible before the generation changes,
+ * so that a reader observing the new generation also observes the new node.
+ */
+static inline void avc_pcpu_invalidate(void)
+{
+	smp_mb__before_atomic();
+	atomic_inc(&avc_pcpu_gen);
+}
+
+/*
+ * The per-CPU cache is only used from task context, so an interrupt on the
+ * same CPU can never observe a half-written entry.
+ */
+static bool avc_pcpu_lookup(u32 gen, u32 ssid, u32 tsid, u16 tclass,
+			    struct av_decision *avd)
+{
+	struct avc_pcpu_entry *e;
+	bool hit = false;
+
+	if (!in_task())
+		return false;
+
+	e = &get_cpu_ptr(&avc_pcpu_cache)->slots[avc_pcpu_hash(ssid, tsid, tclass)];
+	if (e->gen == gen && e->ssid == ssid && e->tsid == tsid &&
+	    e->tclass == tclass) {
+		memcpy(avd, &e->avd, sizeof(*avd));
+		hit = true;
+	}
+	put_cpu_ptr(&avc_pcpu_cache);
+
+	return hit;
+}
+
+static void avc_pcpu_store(u32 gen, u32 ssid, u32 tsid, u16 tclass,
+			   const struct av_decision *avd)
+{
+	struct avc_pcpu_entry *e;
+
+	if (!in_task())
+		return;
+
+	e = &get_cpu_ptr(&avc_pcpu_cache)->slots[avc_pcpu_hash(ssid, tsid, tclass)];
+	e->gen = gen;
+	e->ssid = ssid;
+	e->tsid = tsid;
+	e->tclass = tclass;
+	memcpy(&e->avd, avd, sizeof(e->avd));
+	put_cpu_ptr(&avc_pcpu_cache);
+}
+
 /**
  * avc_init - Initialize the AVC.
  *
@@ -446,6 +524,7 @@ static void avc_node_kill(struct avc_node *node)
 static void avc_node_replace(struct avc_node *new, struct avc_node *old)
 {
 	hlist_replace_rcu(&old->list, &new->list);
+	avc_pcpu_invalidate();
 	call_rcu(&old->rhead, avc_node_free);
 	atomic_dec(&selinux_avc.avc_cache.active_nodes);
 }
@@ -857,6 +936,11 @@ static int avc_update_node(u32 event, u32 perms, u8 driver, u8 xperm, u32 ssid,
 	}
 
 	if (!orig) {
+		/*
+		 * The node may have been reclaimed while a per-CPU copy of
+		 * it is still live; drop those as well.
+		 */
+		avc_pcpu_invalidate();
 		rc = -ENOENT;
 		avc_node_kill(node);
 		goto out_unlock;
@@ -939,6 +1023,8 @@ static void avc_flush(void)
 		rcu_read_unlock();
 		spin_unlock_irqrestore(lock, flag);
 	}
+
+	avc_pcpu_invalidate();
 }
 
 /**
@@ -1140,12 +1226,19 @@ inline int avc_has_perm_noaudit(u32 ssid, u32 tsid,
 				unsigned int flags,
 				struct av_decision *avd)
 {
-	u32 denied;
+	u32 denied, gen;
 	struct avc_node *node;
 
 	if (WARN_ON(!requested))
 		return -EACCES;
 
+	/* Pairs with avc_pcpu_invalidate() */
+	gen = atomic_read_acquire(&avc_pcpu_gen);
+	if (avc_pcpu_lookup(gen, ssid, tsid, tclass, avd)) {
+		denied = requested & ~avd->allowed;
+		goto out;
+	}
+
 	rcu_read_lock();
 	node = avc_lookup(ssid, tsid, tclass);
 	if (unlikely(!node)) {
@@ -1157,6 +1250,8 @@ inline int avc_has_perm_noaudit(u32 ssid, u32 tsid,
 	memcpy(avd, &node->ae.avd, sizeof(*avd));
 	rcu_read_unlock();
 
+	avc_pcpu_store(gen, ssid, tsid, tclass, avd);
+out:
 	if (unlikely(denied))
 		return avc_denied(ssid, tsid, tclass, requested, 0, 0,
 				  flags, avd);
@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: GPL-2.0
+/* MSG_ZEROCOPY on AF_UNIX stream sockets. */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <linux/errqueue.h>
+#include <linux/un.h>
+#include <sys/socket.h>
+
+#include "../../kselftest_harness.h"
+
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY	60
+#endif
+
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY	0x4000000
+#endif
+
+#ifndef SOL_UNIX
+#define SOL_UNIX	288
+#endif
+
+#ifndef UNIX_RECVERR
+#define UNIX_RECVERR	1
+#endif
+
+#define BUF_SIZE	(64 * 1024)
+
+FIXTURE(zerocopy)
+{
+	int fd[2];
+	char *buf;
+};
+
+FIXTURE_SETUP(zerocopy)
+{
+	int one = 1, ret;
+
+	ret = socketpair(AF_UNIX, SOCK_STREAM, 0, self->fd);
+	ASSERT_EQ(0, ret);
+
+	ret = setsockopt(self->fd[0], SOL_SOCKET, SO_ZEROCOPY,
+			 &one, sizeof(one));
+	ASSERT_EQ(0, ret);
+
+	self->buf = malloc(BUF_SIZE);
+	ASSERT_NE(NULL, self->buf);
+	memset(self->buf, 'a', BUF_SIZE);
+}
+
+FIXTURE_TEARDOWN(zerocopy)
+{
+	free(self->buf);
+	close(self->fd[0]);
+	close(self->fd[1]);
+}
+
+/* Wait for and read one completion, returning the range it covers. */
+static void recv_completion(struct __test_metadata *_metadata, int fd,
+			   __u32 *lo, __u32 *hi)
+{
+	char control[CMSG_SPACE(sizeof(struct sock_extended_err))];
+	struct sock_extended_err *serr;
+	struct pollfd pfd = {
+		.fd = fd,
+	};
+	struct msghdr msg = {
+		.msg_control = control,
+		.msg_controllen = sizeof(control),
+	};
+	struct cmsghdr *cm;
+	int ret;
+
+	/* Pending completions are reported as POLLERR */
+	ret = poll(&pfd, 1, 1000);
+	ASSERT_EQ(1, ret);
+	ASSERT_TRUE(pfd.revents & POLLERR);
+
+	ret = recvmsg(fd, &msg, MSG_ERRQUEUE);
+	ASSERT_EQ(0, ret);
+
+	cm = CMSG_FIRSTHDR(&msg);
+	ASSERT_NE(NULL, cm);
+	ASSERT_EQ(SOL_UNIX, cm->cmsg_level);
+	ASSERT_EQ(UNIX_RECVERR, cm->cmsg_type);
+
+	serr = (struct sock_extended_err *)CMSG_DATA(cm);
+	ASSERT_EQ(SO_EE_ORIGIN_ZEROCOPY, serr->ee_origin);
+	ASSERT_EQ(0, serr->ee_errno);
+
+	*lo = serr->ee_info;
+	*hi = serr->ee_data;
+}
+
+TEST_F(zerocopy, recvmsg)
+{
+	char *rbuf;
+	__u32 lo, hi;
+	int ret, i;
+
+	rbuf = malloc(BUF_SIZE);
+	ASSERT_NE(NULL, rbuf);
+
+	for (i = 0; i < 2; i++) {
+		ret = send(self->fd[0], self->buf, BUF_SIZE, MSG_ZEROCOPY);
+		ASSERT_EQ(BUF_SIZE, ret);
+
+		ret = recv(self->fd[1], rbuf, BUF_SIZE, MSG_WAITALL);
+		ASSERT_EQ(BUF_SIZE, ret);
+		ASSERT_EQ(0, memcmp(self->buf, rbuf, BUF_SIZE));
+
+		/* One notification id per send() */
+		recv_completion(_metadata, self->fd[0], &lo, &hi);
+		ASSERT_EQ(i, lo);
+		ASSERT_EQ(i, hi);
+	}
+
+	free(rbuf);
+}
+
+TEST_F(zerocopy, splice)
+{
+	ssize_t ret, spliced = 0;
+	__u32 lo, hi;
+	int pipefd[2];
+	char *rbuf;
+
+	rbuf = malloc(BUF_SIZE);
+	ASSERT_NE(NULL, rbuf);
+
+	ASSERT_EQ(0, pipe(pipefd));
+	ASSERT_LE(BUF_SIZE, fcntl(pipefd[1], F_SETPIPE_SZ, BUF_SIZE));
+
+	ret = send(self->fd[0], self->buf, BUF_SIZE, MSG_ZEROCOPY);
+	ASSERT_EQ(BUF_SIZE, ret);
+
+	while (spliced < BUF_SIZE) {
+		ret = splice(self->fd[1], NULL, pipefd[1], NULL,
+			     BUF_SIZE - spliced, 0);
+		ASSERT_LT(0, ret);
+		spliced += ret;
+	}
+
+	/* Once completed, the pipe must no longer see the sender's pages */
+	recv_completion(_metadata, self->fd[0], &lo, &hi);
+	memset(self->buf, 'b', BUF_SIZE);
+
+	ret = read(pipefd[0], rbuf, BUF_SIZE);
+	ASSERT_EQ(BUF_SIZE, ret);
+	memset(self->buf, 'a', BUF_SIZE);
+	ASSERT_EQ(0, memcmp(self->buf, rbuf, BUF_SIZE));
+
+	close(pipefd[0]);
+	close(pipefd[1]);
+	free(rbuf);
+}
+
+TEST(dgram)
+{
+	int one = 1, fd, ret;
+
+	fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+	ASSERT_LE(0, fd);
+
+	ret = setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one));
+	ASSERT_EQ(-1, ret);
+	ASSERT_EQ(EOPNOTSUPP, errno);
+
+	close(fd);
+}
+
+TEST_HARNESS_MAIN